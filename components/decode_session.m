@@ -0,0 +1,34 @@
+function out = decode_session(in)
+%DECODE_SESSION Restore the full (double) layout of a saved session.
+%
+% out = decode_session(load(matPath))
+%
+% Accepts both storage profiles; full sessions are returned unchanged.
+% See encode_session() for the compact layout.
+
+    out = in;
+    if ~isfield(in, 'format') || in.format ~= "compact-v1"
+        return;
+    end
+
+    for f = ["data", "processed", "SSdata", "window", "SSwindow"]
+        if ~isfield(out, f), continue; end
+        types = fieldnames(out.(f));
+        for k = 1:numel(types)
+            out.(f).(types{k}) = double(out.(f).(types{k}));
+        end
+    end
+    out.rawFeedback  = double(out.rawFeedback);
+    out.normFeedback = double(out.normFeedback);
+    out.markers      = double(out.markers);
+
+    runType = repmat({'neurofeedback'}, numel(out.transfer), 1);
+    runType(out.transfer) = {'transfer'};
+    out.runType = runType;
+    out = rmfield(out, 'transfer');
+
+    t = out.times;
+    n = numel(t.residual_us);
+    out.times = t.start + (0:n-1)' / t.rate + double(t.residual_us) * 1e-6;
+    out = rmfield(out, 'format');
+end
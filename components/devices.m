@@ -30,7 +30,16 @@ classdef devices < handle
                 'modes',       struct(), ...
                 'ui',          struct('blind_role', false), ...
                 'randomize',   false, ...
-                'default_mode', "A" ...
+                'default_mode', "A", ...
+                'storage',     "full", ...
+                'artifacts',   struct('enabled', false, 'threshold', 5, 'tau', 10), ...
+                'mbll',        devices.defaultMbll(), ...
+                'quality',     devices.defaultQuality(), ...
+                'normalization', devices.defaultNormalization(), ...
+                'pipeline',    stagechain.parse([]), ...
+                'threads',     struct('count', 1, 'threshold', 0), ...
+                'resample',    struct('enabled', false, 'rate', 10), ...
+                'spatial',     devices.emptySpatial() ...
             );
 
 
@@ -111,6 +120,123 @@ classdef devices < handle
                 warning('devices:createDeviceStructure:DefaultModeMissing', ...
                     'Device "%s": default_mode missing; defaulting to "A".', device.name);
             end
+
+            % Session storage profile: "full" (double) or "compact"
+            device.storage = "full";
+            if isfield(json,'storage') && ~isempty(json.storage)
+                device.storage = lower(string(json.storage));
+                if ~any(device.storage == ["full", "compact"])
+                    warning('devices:createDeviceStructure:BadStorage', ...
+                        'Device "%s": unknown storage "%s"; using "full".', ...
+                        device.name, device.storage);
+                    device.storage = "full";
+                end
+            end
+
+            % Motion artifact correction before storage (optional)
+            device.artifacts = struct('enabled', false, 'threshold', 5, 'tau', 10);
+            if isfield(json,'artifacts')
+                for f = ["enabled", "threshold", "tau"]
+                    if isfield(json.artifacts, f)
+                        device.artifacts.(f) = json.artifacts.(f);
+                    end
+                end
+                device.artifacts.enabled = logical(device.artifacts.enabled);
+            end
+
+            % Beer-Lambert conversion of raw wavelengths (optional)
+            device.mbll = devices.defaultMbll();
+            if isfield(json,'mbll')
+                for f = string(fieldnames(device.mbll))'
+                    if isfield(json.mbll, f)
+                        device.mbll.(f) = json.mbll.(f);
+                    end
+                end
+                device.mbll.enabled     = logical(device.mbll.enabled);
+                device.mbll.wavelengths = string(device.mbll.wavelengths(:))';
+            end
+
+            % Online signal quality of raw wavelength pairs (optional)
+            device.quality = devices.defaultQuality();
+            if isfield(json,'quality')
+                for f = string(fieldnames(device.quality))'
+                    if isfield(json.quality, f) && ~isempty(json.quality.(f))
+                        device.quality.(f) = json.quality.(f);
+                    end
+                end
+                device.quality.enabled     = logical(device.quality.enabled);
+                device.quality.wavelengths = string(device.quality.wavelengths(:))';
+                device.quality.action      = lower(string(device.quality.action));
+                if ~any(device.quality.action == ["none", "drop", "weight"])
+                    warning('devices:createDeviceStructure:BadQualityAction', ...
+                        'Device "%s": unknown quality action "%s"; using "none".', ...
+                        device.name, device.quality.action);
+                    device.quality.action = "none";
+                end
+            end
+
+            % Adaptive feedback normalization (optional overrides)
+            device.normalization = devices.defaultNormalization();
+            if isfield(json,'normalization')
+                for f = string(fieldnames(device.normalization))'
+                    if isfield(json.normalization, f)
+                        device.normalization.(f) = json.normalization.(f);
+                    end
+                end
+                device.normalization.scope = lower(string(device.normalization.scope));
+                if ~any(device.normalization.scope == ["run", "epoch"])
+                    warning('devices:createDeviceStructure:BadNormScope', ...
+                        'Device "%s": unknown normalization scope "%s"; using "run".', ...
+                        device.name, device.normalization.scope);
+                    device.normalization.scope = "run";
+                end
+            end
+
+            % Fixed processing rate, resampled from the stream (optional)
+            device.resample = struct('enabled', false, 'rate', 10);
+            if isfield(json,'resample')
+                for f = ["enabled", "rate"]
+                    if isfield(json.resample, f)
+                        device.resample.(f) = json.resample.(f);
+                    end
+                end
+                device.resample.enabled = logical(device.resample.enabled);
+                device.resample.rate    = double(device.resample.rate);
+            end
+
+            % Threads for per-channel filtering (optional, 0 = all cores,
+            % threshold 0 = measured)
+            device.threads = struct('count', 1, 'threshold', 0);
+            if isfield(json,'threads')
+                for f = ["count", "threshold"]
+                    if isfield(json.threads, f)
+                        device.threads.(f) = double(json.threads.(f));
+                    end
+                end
+            end
+
+            % Preprocessing chain for the Pipeline protocol (optional)
+            device.pipeline = stagechain.parse([]);
+            if isfield(json,'pipeline')
+                device.pipeline = stagechain.parse(json.pipeline);
+            end
+
+            % Spatial filters registering derived channel types (optional)
+            device.spatial = devices.emptySpatial();
+            if isfield(json,'spatial')
+                for s = json.spatial(:)'
+                    if iscell(s), s = s{1}; end
+                    f = devices.emptySpatial();
+                    f(1).name       = string(s.name);
+                    f(1).source     = string(s.source);
+                    f(1).method     = lower(string(s.method));
+                    f(1).components = 1;
+                    if isfield(s, 'components')
+                        f(1).components = double(s.components);
+                    end
+                    device.spatial(end+1) = f;
+                end
+            end
         end
         
         function ok = select(self, type, name)
@@ -215,4 +341,45 @@ classdef devices < handle
         end
 
     end
+
+    methods (Static)
+        function s = emptySpatial()
+            % name = derived type, source = selected type it is built
+            % from, method = "car" | "pca", components removed (pca)
+            s = struct('name', {}, 'source', {}, 'method', {}, 'components', {});
+        end
+
+        function m = defaultMbll()
+            % Extinction coefficients (1/(cm*M), Prahl) as
+            % [HbO HbR] per wavelength, DPF per wavelength, distance (cm)
+            % scalar or per devch, baseline (s) for the initial intensity
+            m = struct( ...
+                'enabled',     false, ...
+                'wavelengths', ["WL760NM" "WL850NM"], ...
+                'extinction',  [586 1548.52; 1058 691.32], ...
+                'dpf',         [6.0 6.0], ...
+                'distance',    3.0, ...
+                'baseline',    10.0);
+        end
+
+        function n = defaultNormalization()
+            % raw feedback percentiles (%) mapped to 0 and 1, tracked
+            % over the whole run or per epoch type ("epoch")
+            n = struct('low', 5, 'high', 95, 'scope', "run");
+        end
+
+        function q = defaultQuality()
+            % SCI/CV/saturation over window (s) of the wavelength pairs,
+            % action on bad channels: "none" (mask only), "drop"
+            % (replace by good channels' mean) or "weight" (blend by SCI)
+            q = struct( ...
+                'enabled',     false, ...
+                'wavelengths', ["WL760NM" "WL850NM"], ...
+                'window',      5.0, ...
+                'sci',         0.75, ...
+                'cv',          7.5, ...
+                'saturation',  Inf, ...
+                'action',      "none");
+        end
+    end
 end
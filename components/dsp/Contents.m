@@ -0,0 +1,38 @@
+% NINFA_DSP Streaming multi-channel signal processing for protocols
+%
+% All objects are created once (e.g. in a protocol's init) and then fed
+% blocks of new samples. Blocks are n x channels (rows = samples,
+% columns = channels); filter states are kept as (state x channels) so
+% every call runs natively over all channels at once. No Signal
+% Processing Toolbox functions are used at runtime.
+%
+% Filters
+%   iirfilter    - IIR (b,a) with steady-state priming and filtered window
+%   sosfilter    - Biquad cascade (second-order sections)
+%   firfilter    - FIR, computes only the newest outputs
+%   decimator    - Anti-aliased decimation by an integer factor
+%   resampler    - Timestamp-driven polyphase resampling to a fixed rate
+%   detrender    - Sliding-window linear detrending
+%   bandpower    - Welch band power at a fixed output rate
+%   artifactfilter - Motion artifact (step) detection and correction
+%   spatialfilter - Common average / PCA global signal removal
+%   mbll         - Raw wavelength intensities to HbO/HbR (Beer-Lambert)
+%   signalquality - Scalp coupling index, CV and saturation per channel
+%
+% Window statistics
+%   windowstats  - Moving average/variance with compensated sums
+%   slidingwindow - Ring buffer of the last rows with windowstats
+%   ssregression - Sliding short-separation regression
+%   p2quantile   - Streaming quantile estimate (P² algorithm)
+%   restbaseline - Preallocated rest buffer, amplitude and rest mean
+%   feedbacknorm - Adaptive raw feedback to [0,1] mapping by percentiles
+%   rlsglm       - Recursive least squares GLM with shared regressors
+%   slidingcorr  - Sliding-window correlation of signal pairs
+%
+% Execution
+%   channelpool  - Channel partitions of large blocks on background threads
+%
+% Design
+%   butterworth  - Butterworth low/high/bandpass as SOS
+%   gausskernel  - Gaussian FIR kernel (as gaussfir)
+%   hrfkernel    - Canonical (double gamma) HRF as FIR kernel
@@ -0,0 +1,71 @@
+classdef artifactfilter < handle
+    %ARTIFACTFILTER Streaming motion artifact detection and correction
+    %   Works on the sample-to-sample derivative of each channel. Its
+    %   typical size is tracked as a running mean absolute derivative
+    %   (only non-artifact steps, so spikes do not inflate it). A step
+    %   larger than threshold times that scale is flagged and removed
+    %   from the output, i.e. the corrected signal continues from its
+    %   previous value. Spikes (up and down) and baseline shifts are
+    %   both removed without lookahead. O(channels) per sample.
+
+    properties
+        threshold   double  = 5;            % flag steps above threshold * scale
+        alpha       double  = 0.01;         % scale update weight
+        warmup      double  = 0;            % samples before detection starts
+        prev        double  = zeros(1,0);   % last raw sample
+        out         double  = zeros(1,0);   % last corrected sample
+        scale       double  = zeros(1,0);   % mean absolute derivative
+        count       double  = 0;            % samples seen
+    end
+
+    methods
+        function self = artifactfilter(nch, srate, threshold, tau)
+            %ARTIFACTFILTER nch channels, scale averaged over tau seconds
+            if nargin < 2, nch = 0; srate = 1; end
+            if nargin < 3, threshold = 5; end
+            if nargin < 4, tau = 10; end
+            self.threshold = threshold;
+            self.alpha     = 1 / max(tau * srate, 1);
+            self.warmup    = ceil(tau * srate / 2);
+            self.prev      = zeros(1, nch);
+            self.out       = zeros(1, nch);
+            self.scale     = zeros(1, nch);
+            self.reset();
+        end
+
+        function reset(self)
+            self.prev(:)  = 0;
+            self.out(:)   = 0;
+            self.scale(:) = 0;
+            self.count    = 0;
+        end
+
+        function [y, bad] = push(self, x)
+            %PUSH Correct block x (n x channels), bad marks flagged steps
+            y   = zeros(size(x));
+            bad = false(size(x));
+            for i = 1:size(x,1)
+                self.count = self.count + 1;
+                if self.count == 1
+                    self.prev = x(i,:);
+                    self.out  = x(i,:);
+                    y(i,:)    = x(i,:);
+                    continue;
+                end
+                d = x(i,:) - self.prev;
+                self.prev = x(i,:);
+                a = abs(d);
+                if self.count > self.warmup
+                    b = a > self.threshold * self.scale;
+                    d(b) = 0;
+                    a(b) = self.scale(b);
+                    bad(i,:) = b;
+                end
+                w = max(self.alpha, 1 / (self.count - 1));
+                self.scale = (1 - w) * self.scale + w * a;
+                self.out = self.out + d;
+                y(i,:) = self.out;
+            end
+        end
+    end
+end
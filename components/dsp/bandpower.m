@@ -0,0 +1,107 @@
+classdef bandpower < handle
+    %BANDPOWER Streaming Welch band power over a sliding window
+    %   Raw blocks (n x channels) are written into a ring; every hop
+    %   samples (srate / outrate) the last window is split into 50%
+    %   overlapping Hann segments, transformed with one fft call over all
+    %   segments and channels, and the one-sided PSD is summed per band
+    %   through a precomputed bin-to-band matrix. Cost per input sample
+    %   is one ring write; FFTs only run at the output rate.
+
+    properties
+        srate       double  = 1;            % input sample rate (Hz)
+        hop         double  = 1;            % input samples per output
+        len         double  = 0;            % window length (samples)
+        seglen      double  = 0;            % Welch segment length
+        nfft        double  = 0;            % FFT length
+        segidx      double  = zeros(0,0);   % window rows per segment (seglen x nseg)
+        taper       double  = zeros(0,1);   % Hann taper (seglen x 1)
+        W           double  = zeros(0,0);   % PSD bins to band power (nfreq x bands)
+        bands       double  = zeros(0,2);   % band edges (Hz)
+        ring        double  = zeros(0,0);   % raw window (ring buffer)
+        head        double  = 0;            % last written row in ring
+        count       double  = 0;            % valid rows in ring
+        since       double  = 0;            % samples since last output
+    end
+
+    methods
+        function self = bandpower(srate, nch, bands, outrate, window)
+            %BANDPOWER bands (k x 2, Hz), outputs per second, window (s)
+            if nargin < 3, srate = 1; nch = 0; bands = zeros(0,2); end
+            if nargin < 4, outrate = 20; end
+            if nargin < 5, window = 1.0; end
+            self.srate  = srate;
+            self.bands  = bands;
+            self.hop    = max(round(srate / outrate), 1);
+            self.len    = max(round(srate * window), 2);
+            self.seglen = floor(self.len / 2);
+            self.nfft   = max(2^nextpow2(self.seglen), 2);
+            self.ring   = zeros(self.len, nch);
+
+            % 50% overlapping segments inside the window
+            step   = max(floor(self.seglen / 2), 1);
+            starts = 0:step:self.len-self.seglen;
+            self.segidx = (1:self.seglen)' + starts;
+            n = (0:self.seglen-1)';
+            self.taper = 0.5 - 0.5 * cos(2*pi*n / self.seglen);
+
+            % one-sided PSD scaling and band summation in one matrix
+            nfreq = self.nfft/2 + 1;
+            f  = (0:nfreq-1)' * srate / self.nfft;
+            df = srate / self.nfft;
+            s  = 2 * ones(nfreq, 1);
+            s([1 end]) = 1;
+            s  = s * df / (srate * sum(self.taper.^2));
+            self.W = zeros(nfreq, size(bands,1));
+            for k = 1:size(bands,1)
+                self.W(:,k) = s .* (f >= bands(k,1) & f < bands(k,2));
+            end
+            self.reset();
+        end
+
+        function reset(self)
+            self.ring(:) = 0;
+            self.head    = 0;
+            self.count   = 0;
+            self.since   = 0;
+        end
+
+        function [P, at] = push(self, x)
+            %PUSH Add block x, P (m x channels x bands) for each output
+            %   and at (m x 1) the row of x at which it was computed
+            nb = size(self.bands, 1);
+            P  = zeros(0, size(x,2), nb);
+            at = zeros(0, 1);
+            pos = 0;
+            n = size(x, 1);
+            while pos < n
+                take = min(n - pos, self.hop - self.since);
+                rows = mod(self.head + (0:take-1), self.len) + 1;
+                self.ring(rows,:) = x(pos+1:pos+take,:);
+                self.head  = rows(end);
+                self.count = min(self.count + take, self.len);
+                self.since = self.since + take;
+                pos = pos + take;
+                if self.since >= self.hop
+                    self.since = 0;
+                    if self.count >= self.len
+                        P(end+1,:,:) = reshape(self.compute()', [1 size(x,2) nb]);
+                        at(end+1,1) = pos;
+                    end
+                end
+            end
+        end
+
+        function p = compute(self)
+            %COMPUTE Band power (bands x channels) of the current window
+            w = self.ring(mod(self.head + (0:self.len-1), self.len) + 1, :);
+            nch  = size(w, 2);
+            nseg = size(self.segidx, 2);
+            S = reshape(w(self.segidx(:),:), self.seglen, nseg, nch);
+            S = (S - mean(S, 1)) .* self.taper;
+            F = fft(S, self.nfft, 1);
+            F = F(1:self.nfft/2+1,:,:);
+            psd = reshape(mean(abs(F).^2, 2), [], nch);
+            p = self.W' * psd;
+        end
+    end
+end
@@ -0,0 +1,77 @@
+function sos = butterworth(order, fc, fs, type)
+%BUTTERWORTH Digital Butterworth design as second-order sections.
+%
+% sos = butterworth(order, fc, fs, type)
+%
+% Inputs:
+%   order : prototype order (bandpass results in 2*order poles)
+%   fc    : cutoff in Hz, [low high] for "bandpass"
+%   fs    : sample rate in Hz
+%   type  : "low" | "high" | "bandpass"
+%
+% Output:
+%   sos   : one section per row [b0 b1 b2 1 a1 a2], unity passband gain
+%
+% Notes:
+% - Bilinear transform with prewarped cutoffs, no Signal Processing
+%   Toolbox needed at runtime. Use with sosfilter.
+
+    type = lower(string(type));
+    k  = (1:order)';
+    p  = exp(1i*pi*(2*k+order-1)/(2*order));   % analog prototype poles
+    w  = 2*fs*tan(pi*fc/fs);                     % prewarped cutoffs
+
+    switch type
+        case "low"
+            pa   = w(1) * p;
+            zd   = -ones(order,1);
+            zref = 1;
+        case "high"
+            pa   = w(1) ./ p;
+            zd   = ones(order,1);
+            zref = -1;
+        case "bandpass"
+            bw   = w(2) - w(1);
+            w0   = sqrt(w(1)*w(2));
+            t    = bw * p / 2;
+            d    = sqrt(t.^2 - w0^2);
+            pa   = [t + d; t - d];
+            zd   = [ones(order,1); -ones(order,1)];
+            zref = exp(1i*2*atan(w0/(2*fs)));
+        otherwise
+            error('butterworth:BadType', 'Unknown filter type "%s".', type);
+    end
+
+    % bilinear transform of the poles (zeros are already digital)
+    pd = (2*fs + pa) ./ (2*fs - pa);
+
+    % denominators: conjugate pairs, then real poles in pairs
+    pc = pd(imag(pd) > 1e-12);
+    pr = sort(real(pd(abs(imag(pd)) <= 1e-12)));
+    A  = [ones(numel(pc),1), -2*real(pc), abs(pc).^2];
+    while numel(pr) >= 2
+        A(end+1,:) = [1, -(pr(1)+pr(2)), pr(1)*pr(2)]; %#ok<AGROW>
+        pr(1:2) = [];
+    end
+    if ~isempty(pr)
+        A(end+1,:) = [1, -pr(1), 0];
+    end
+
+    % numerators: pair outermost zeros (+1 with -1 for bandpass)
+    zd = sort(zd);
+    B  = zeros(0,3);
+    while numel(zd) >= 2
+        B(end+1,:) = [1, -(zd(1)+zd(end)), zd(1)*zd(end)]; %#ok<AGROW>
+        zd([1 end]) = [];
+    end
+    if ~isempty(zd)
+        B(end+1,:) = [1, -zd(1), 0];
+    end
+
+    % unity gain at the passband reference frequency
+    zi = [1; 1/zref; 1/zref^2];
+    h  = prod((B*zi) ./ (A*zi));
+    B(1,:) = B(1,:) / abs(h);
+
+    sos = [B, A];
+end
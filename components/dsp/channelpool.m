@@ -0,0 +1,127 @@
+classdef channelpool < handle
+    %CHANNELPOOL Runs per-channel kernels on column partitions in threads
+    %   run(fn, x, z) evaluates [y, z] = fn(x, z) for a block x (n x
+    %   channels) and a kernel state z with channels along dimension 2.
+    %   With more than one thread and at least threshold elements in x,
+    %   the channels are split into one contiguous partition per thread
+    %   and evaluated on the thread-based background pool (parfeval);
+    %   otherwise, and without the Parallel Computing Toolbox, fn runs
+    %   directly on the client. fn must not capture handle objects (they
+    %   would be copied to the threads), pass plain coefficients.
+    %
+    %   The filters in this folder use the shared instance, configured
+    %   on session start from the device's "threads" settings. Only the
+    %   filter kernels are split; the per-row regressions (rlsglm,
+    %   ssregression, stagechain ss_regress) stay on the client.
+    %   A threshold of 0 is measured on configure (see calibrate).
+
+    properties
+        threads     double  = 1;            % partitions (1 = single-threaded)
+        threshold   double  = 0;            % minimum elements per call to split
+        pool        = [];                   % background pool ([] = client only)
+    end
+
+    methods
+        function self = channelpool(threads, threshold)
+            if nargin < 1, threads = 1; end
+            if nargin < 2, threshold = 0; end
+            self.configure(threads, threshold);
+        end
+
+        function configure(self, threads, threshold)
+            %CONFIGURE threads (0 = number of cores) and small-work
+            %   threshold (0 = measured by calibrate)
+            if threads <= 0
+                threads = maxNumCompThreads;
+            end
+            self.threads   = threads;
+            self.threshold = threshold;
+            self.pool      = [];
+            if threads <= 1 || isempty(ver('parallel'))
+                return;
+            end
+            try
+                self.pool = backgroundPool;
+                self.threads = min(threads, self.pool.NumWorkers);
+            catch err
+                warning('channelpool:NoPool', ...
+                    'Processing channels single-threaded: %s', err.message);
+                self.pool = [];
+                return;
+            end
+            if self.threshold <= 0
+                self.threshold = self.calibrate();
+            end
+        end
+
+        function t = calibrate(self)
+            %CALIBRATE Elements per call from which splitting pays off
+            %   Times the round trip of one empty future per thread
+            %   (dispatch) and a 4th-order filter over a test block on the
+            %   client (per element). Splitting n elements over k threads
+            %   saves about (1-1/k) of their time, so it pays off above
+            %   dispatch / ((1-1/k) * per element).
+            k = self.threads;
+            b = [0.2 0.2 0.2 0.2 0.2];
+            a = [1 -0.5 0.25 -0.125 0.0625];
+            x = randn(2000, 64);
+            z = zeros(4, 64);
+            filter(b, a, x, z);
+            tick = tic();
+            for r = 1:5
+                filter(b, a, x, z);
+            end
+            pervalue = toc(tick) / (5 * numel(x));
+
+            dispatch = Inf;
+            for r = 1:6
+                tick = tic();
+                futures = parallel.FevalFuture.empty;
+                for p = 1:k
+                    futures(p) = parfeval(self.pool, @plus, 1, 0, 0);
+                end
+                fetchOutputs(futures);
+                if r > 1
+                    % first round starts the pool
+                    dispatch = min(dispatch, toc(tick));
+                end
+            end
+            t = ceil(dispatch / ((1 - 1/k) * pervalue));
+        end
+
+        function [y, z] = run(self, fn, x, z)
+            %RUN [y, z] = fn(x, z), split over channels if worthwhile
+            nch = size(x, 2);
+            k = min(self.threads, nch);
+            if isempty(self.pool) || k <= 1 || numel(x) < self.threshold
+                [y, z] = fn(x, z);
+                return;
+            end
+            edges = round(linspace(0, nch, k + 1));
+            zidx = repmat({':'}, 1, ndims(z));
+            futures = parallel.FevalFuture.empty;
+            for p = 1:k
+                cols = edges(p)+1:edges(p+1);
+                zidx{2} = cols;
+                futures(p) = parfeval(self.pool, fn, 2, x(:,cols), z(zidx{:}));
+            end
+            y = zeros(size(x));
+            for p = 1:k
+                cols = edges(p)+1:edges(p+1);
+                zidx{2} = cols;
+                [y(:,cols), z(zidx{:})] = fetchOutputs(futures(p));
+            end
+        end
+    end
+
+    methods (Static)
+        function p = shared()
+            %SHARED Instance used by the streaming filters
+            persistent instance;
+            if isempty(instance) || ~isvalid(instance)
+                instance = channelpool();
+            end
+            p = instance;
+        end
+    end
+end
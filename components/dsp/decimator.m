@@ -0,0 +1,52 @@
+classdef decimator < handle
+    %DECIMATOR Streaming multi-channel anti-aliased decimation by M
+    %   Low-pass filters new samples with a windowed-sinc FIR (cutoff
+    %   0.8 * fs/(2M)) and returns every M-th output row. The phase is
+    %   kept between calls, so any block size can be pushed.
+
+    properties
+        M           uint32  = 1;            % decimation factor
+        h           double  = 1;            % anti-aliasing kernel
+        zi          double  = zeros(0,0);   % FIR state (taps-1 x channels)
+        phase       uint32  = 0;            % samples since last output
+    end
+
+    methods
+        function self = decimator(M, nch, taps)
+            %DECIMATOR Create decimator by M for nch channels
+            if nargin < 3, taps = 8*M + 1; end
+            self.M  = M;
+            self.h  = decimator.kernel(M, taps);
+            self.zi = zeros(numel(self.h)-1, nch);
+        end
+
+        function y = push(self, x)
+            %PUSH Filter block x (n x channels), return decimated rows
+            [f, self.zi] = filter(self.h, 1, x, self.zi);
+            n    = size(x, 1);
+            M    = double(self.M);
+            keep = (M - double(self.phase)):M:n;
+            y    = f(keep,:);
+            self.phase = uint32(mod(double(self.phase) + n, M));
+        end
+
+        function reset(self)
+            self.zi(:)  = 0;
+            self.phase  = 0;
+        end
+    end
+
+    methods (Static)
+        function h = kernel(M, taps)
+            %KERNEL Hamming-windowed sinc low-pass for factor M
+            fc = 0.8 / double(M);                  % relative to Nyquist
+            n  = (0:taps-1) - (taps-1)/2;
+            x  = pi * fc * n;
+            h  = fc * ones(size(n));
+            h(x ~= 0) = fc * sin(x(x ~= 0)) ./ x(x ~= 0);
+            w  = 0.54 - 0.46 * cos(2*pi*(0:taps-1)/(taps-1));
+            h  = h .* w;
+            h  = h / sum(h);
+        end
+    end
+end
@@ -0,0 +1,91 @@
+classdef detrender < handle
+    %DETRENDER Sliding-window linear detrending per channel
+    %   Keeps sum(x) and sum(t*x) over the last len samples, so the least
+    %   squares line of every channel is available in O(channels) per
+    %   sample. push() returns the new samples minus the current trend.
+    %   Sums are recomputed from the ring once per window length.
+
+    properties
+        len         uint32  = 0;            % window length (rows)
+        count       uint32  = 0;            % rows currently in window
+        head        uint32  = 0;            % last written row in ring
+        pushes      uint32  = 0;            % pushes since last resync
+        ring        double  = zeros(0,0);   % raw window (ring buffer)
+        sx          double  = zeros(1,0);   % sum of x
+        stx         double  = zeros(1,0);   % sum of t*x, t = 0 for oldest
+    end
+
+    methods
+        function self = detrender(len, nch)
+            self.len  = len;
+            self.ring = zeros(len, nch);
+            self.reset();
+        end
+
+        function reset(self)
+            self.count  = 0;
+            self.head   = 0;
+            self.pushes = 0;
+            self.ring(:) = 0;
+            self.sx  = zeros(1, size(self.ring, 2));
+            self.stx = zeros(1, size(self.ring, 2));
+        end
+
+        function y = push(self, x)
+            %PUSH Add block x (n x channels), return detrended rows
+            y = zeros(size(x));
+            for i = 1:size(x, 1)
+                self.head = mod(self.head, self.len) + 1;
+                if self.count < self.len
+                    self.count = self.count + 1;
+                else
+                    % drop oldest (t = 0), shift remaining t down by one
+                    old = self.ring(self.head,:);
+                    self.sx  = self.sx - old;
+                    self.stx = self.stx - self.sx;
+                end
+                self.ring(self.head,:) = x(i,:);
+                self.sx  = self.sx  + x(i,:);
+                self.stx = self.stx + double(self.count - 1) * x(i,:);
+
+                self.pushes = self.pushes + 1;
+                if self.pushes >= self.len
+                    self.resync();
+                end
+
+                [a, b] = self.trend();
+                y(i,:) = x(i,:) - (a + b * double(self.count - 1));
+            end
+        end
+
+        function [a, b] = trend(self)
+            %TREND Intercept a (at oldest row) and slope b per channel
+            n = double(self.count);
+            if n < 2
+                a = self.sx / max(n, 1);
+                b = zeros(size(self.sx));
+                return;
+            end
+            st  = n * (n - 1) / 2;
+            stt = (n - 1) * n * (2*n - 1) / 6;
+            b = (n * self.stx - st * self.sx) / (n * stt - st^2);
+            a = (self.sx - b * st) / n;
+        end
+    end
+
+    methods (Access = private)
+        function resync(self)
+            n = double(self.count);
+            if n < double(self.len)
+                order = 1:n;
+            else
+                order = [self.head+1:self.len, 1:self.head];
+            end
+            t = (0:n-1)';
+            w = self.ring(order,:);
+            self.sx  = sum(w, 1);
+            self.stx = sum(t .* w, 1);
+            self.pushes = 0;
+        end
+    end
+end
@@ -0,0 +1,87 @@
+classdef feedbacknorm < handle
+    %FEEDBACKNORM Adaptive mapping of raw feedback to [0,1]
+    %   Tracks the low and high percentile of the raw feedback with two
+    %   P² estimators and maps a value linearly from [qlow, qhigh] to
+    %   [0,1] (clamped), so the bar follows the subject's own range
+    %   instead of expected constants. With scope "run" all values
+    %   share one pair of estimators, with "epoch" every epoch type
+    %   (marker) has its own. Until MINCOUNT values are seen, 0.5 is
+    %   returned. O(1) per value.
+
+    properties (Constant)
+        MINCOUNT    = 10;                   % values before mapping starts
+    end
+
+    properties
+        low         double  = 0.05;         % lower percentile (0-1)
+        high        double  = 0.95;         % upper percentile (0-1)
+        scope       string  = "run";        % "run" | "epoch"
+        trackers    struct  = struct();     % [qlow qhigh] p2quantile per key
+    end
+
+    methods
+        function self = feedbacknorm(cfg)
+            %FEEDBACKNORM From device.normalization (percentiles in %)
+            if nargin < 1, cfg = devices.defaultNormalization(); end
+            self.low   = cfg.low / 100;
+            self.high  = cfg.high / 100;
+            self.scope = cfg.scope;
+        end
+
+        function reset(self)
+            self.trackers = struct();
+        end
+
+        function y = push(self, raw, marker)
+            %PUSH Add raw values (n x 1) of epoch type marker, map them
+            if nargin < 3, marker = 0; end
+            q = self.tracker(marker);
+            y = zeros(size(raw));
+            for i = 1:numel(raw)
+                q(1).push(raw(i));
+                q(2).push(raw(i));
+                y(i) = feedbacknorm.scale(raw(i), q);
+            end
+        end
+
+        function y = map(self, raw, marker)
+            %MAP Map raw values with the current estimates (no update)
+            if nargin < 3, marker = 0; end
+            q = self.tracker(marker);
+            y = arrayfun(@(v) feedbacknorm.scale(v, q), raw);
+        end
+
+        function [lo, hi] = range(self, marker)
+            %RANGE Current raw values mapped to 0 and 1
+            if nargin < 2, marker = 0; end
+            q = self.tracker(marker);
+            lo = q(1).value();
+            hi = q(2).value();
+        end
+    end
+
+    methods (Access = private)
+        function q = tracker(self, marker)
+            key = 'run';
+            if self.scope == "epoch"
+                key = sprintf('m%d', round(marker));
+            end
+            if ~isfield(self.trackers, key)
+                self.trackers.(key) = [p2quantile(self.low), p2quantile(self.high)];
+            end
+            q = self.trackers.(key);
+        end
+    end
+
+    methods (Static, Access = private)
+        function y = scale(v, q)
+            if q(1).count < feedbacknorm.MINCOUNT
+                y = 0.5;
+                return;
+            end
+            lo = q(1).value();
+            hi = q(2).value();
+            y  = min(max((v - lo) / max(hi - lo, eps), 0.0), 1.0);
+        end
+    end
+end
@@ -0,0 +1,21 @@
+classdef firfilter < iirfilter
+    %FIRFILTER Stateful multi-channel FIR filter over a sliding window
+    %   Streaming replacement for conv(x, h, 'same') on every window:
+    %   only the newest output rows are computed, all channels at once
+    %   (filter() runs the kernel natively across the columns), and the
+    %   last windowsize outputs are kept in the ring of iirfilter.
+    %   Note the output is causal, i.e. delayed by (numel(h)-1)/2
+    %   samples compared to the centered 'same' convolution.
+
+    methods
+        function self = firfilter(h, nch, windowsize)
+            %FIRFILTER Create filter with kernel h
+            self@iirfilter(h, 1, nch, windowsize);
+        end
+
+        function d = delay(self)
+            %DELAY Group delay in samples of a symmetric kernel
+            d = (numel(self.b) - 1) / 2;
+        end
+    end
+end
@@ -0,0 +1,23 @@
+function h = gausskernel(bt, nt, of)
+%GAUSSKERNEL Gaussian FIR kernel, same as gaussfir(bt, nt, of).
+%
+% h = gausskernel(bt, nt, of)
+%
+% Inputs:
+%   bt : 3-dB bandwidth-symbol time product
+%   nt : number of symbol periods between start and peak (default 3)
+%   of : oversampling factor (default 2)
+%
+% Output:
+%   h  : row vector of 2*nt*of+1 taps, normalized to unit sum
+%
+% Notes:
+% - Avoids the Signal Processing Toolbox at runtime. Use with firfilter.
+
+    if nargin < 2, nt = 3; end
+    if nargin < 3, of = 2; end
+    alpha = sqrt(log(2)/2) / bt;
+    t = (-nt*of:nt*of) / of;
+    h = (sqrt(pi)/alpha) * exp(-(t*pi/alpha).^2);
+    h = h / sum(h);
+end
@@ -0,0 +1,21 @@
+function h = hrfkernel(srate, len)
+%HRFKERNEL Canonical (double gamma) hemodynamic response as FIR kernel.
+%
+% h = hrfkernel(srate, len)
+%
+% Inputs:
+%   srate : sample rate (Hz)
+%   len   : kernel length in seconds (default 32)
+%
+% Output:
+%   h     : row vector, peak ~5 s, undershoot ~15 s, unit sum
+%
+% Notes:
+% - Same shape as SPM's canonical HRF (gamma 6 minus gamma 16 / 6).
+% - Use with firfilter to convolve a task boxcar sample by sample.
+
+    if nargin < 2, len = 32; end
+    t = (0:floor(len*srate)) / srate;
+    h = t.^5 .* exp(-t) / gamma(6) - t.^15 .* exp(-t) / gamma(16) / 6;
+    h = h / sum(h);
+end
@@ -0,0 +1,88 @@
+classdef iirfilter < handle
+    %IIRFILTER Stateful multi-channel IIR filter over a sliding window
+    %   Filters only new samples (rows = samples, columns = channels),
+    %   keeping the filter state between calls, and stores the last
+    %   windowsize outputs in a slidingwindow (ring buffer with stats).
+    %   The state is primed to the steady state of the first sample, so
+    %   there is no start-up transient.
+
+    properties
+        b           double  = 1;            % numerator coefficients
+        a           double  = 1;            % denominator coefficients
+        zi          double  = zeros(0,0);   % filter state (order x channels)
+        zss         double  = zeros(0,1);   % steady-state for a unit step
+        primed      logical = false;        % true after the first sample
+        win         slidingwindow;          % filtered window
+    end
+
+    methods
+        function self = iirfilter(b, a, nch, windowsize)
+            %IIRFILTER Create filter for nch channels and window length
+            self.b    = b(:)' / a(1);
+            self.a    = a(:)' / a(1);
+            nfilt     = max(numel(self.a), numel(self.b));
+            self.b(end+1:nfilt) = 0;
+            self.a(end+1:nfilt) = 0;
+            self.zss  = iirfilter.steadystate(self.b, self.a);
+            self.zi   = zeros(nfilt-1, nch);
+            self.win  = slidingwindow(windowsize, nch);
+        end
+
+        function [y, m] = push(self, x, need)
+            %PUSH Filter a block of new samples (n x channels)
+            %   Optional m (n x 1) is the grand mean of the filtered window
+            %   after each row with need(i) (see slidingwindow.push).
+            y = self.step(x);
+            if nargout > 1
+                if nargin < 3, need = true(size(x,1), 1); end
+                m = self.win.push(y, need);
+            else
+                self.win.push(y);
+            end
+        end
+
+        function w = window(self)
+            %WINDOW Filtered window, oldest row first
+            w = self.win.window();
+        end
+
+        function m = windowmean(self)
+            %WINDOWMEAN Mean per channel over the filtered window
+            m = self.win.mean();
+        end
+
+        function reset(self)
+            self.zi(:)   = 0;
+            self.primed  = false;
+            self.win.reset();
+        end
+    end
+
+    methods (Access = protected)
+        function y = step(self, x)
+            %STEP Filter x, keeping the state (primed on first call)
+            %   Large blocks are split over channels (channelpool).
+            if ~self.primed
+                self.zi = self.zss * x(1,:);
+                self.primed = true;
+            end
+            b = self.b;
+            a = self.a;
+            [y, self.zi] = channelpool.shared().run( ...
+                @(x, z) filter(b, a, x, z), x, self.zi);
+        end
+    end
+
+    methods (Static)
+        function z = steadystate(b, a)
+            %STEADYSTATE Filter state for a constant unit input
+            n = numel(a);
+            if n < 2
+                z = zeros(0,1);
+                return;
+            end
+            A = eye(n-1) - [-a(2:n)', [eye(n-2); zeros(1,n-2)]];
+            z = A \ (b(2:n)' - b(1) * a(2:n)');
+        end
+    end
+end
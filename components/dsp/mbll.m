@@ -0,0 +1,86 @@
+classdef mbll < handle
+    %MBLL Streaming modified Beer-Lambert law on raw NIRS intensities
+    %   Converts the intensities of two wavelengths per source-detector
+    %   pair (devch) into HbO/HbR concentration changes:
+    %
+    %       OD(w)       = -log10(I(w) / I0(w))
+    %       [HbO; HbR]  = inv(E) * [OD(w1) / (d*DPF(w1)); OD(w2) / (d*DPF(w2))]
+    %
+    %   E holds the molar extinction coefficients (1/(cm*M)), d the
+    %   source-detector distance (cm). I0 is the per-channel mean of
+    %   the first baseline seconds. push() takes a full LSL sample and
+    %   overwrites its HbO/HbR entries (μmol/L), so the converted values
+    %   appear as regular HbO/HbR channels. O(channels) per sample.
+
+    properties
+        wl1         double  = zeros(1,0);   % sample index of 1st wavelength
+        wl2         double  = zeros(1,0);   % sample index of 2nd wavelength
+        hbo         double  = zeros(1,0);   % sample index of HbO output (0 = none)
+        hbr         double  = zeros(1,0);   % sample index of HbR output (0 = none)
+        Einv        double  = eye(2);       % inverse extinction matrix
+        scale       double  = zeros(2,0);   % 1/(d*DPF) per wavelength/channel
+        I0          double  = zeros(2,0);   % baseline intensities
+        nbase       double  = 1;            % samples in baseline
+        count       double  = 0;            % samples seen
+    end
+
+    methods
+        function self = mbll(channels, cfg, srate)
+            %MBLL From device.lsl.channels and device.mbll
+            if nargin < 3, return; end
+            ch    = channels(:)';
+            types = string({ch.type});
+            devch = double([ch.devch]);
+            i1 = find(types == cfg.wavelengths(1));
+            for k = i1
+                d  = devch(k);
+                k2 = find(types == cfg.wavelengths(2) & devch == d, 1);
+                if isempty(k2), continue; end
+                ko = find(types == "HbO" & devch == d, 1);
+                kr = find(types == "HbR" & devch == d, 1);
+                if isempty(ko) && isempty(kr), continue; end
+                if isempty(ko), ko = 0; end
+                if isempty(kr), kr = 0; end
+                self.wl1(end+1) = k;
+                self.wl2(end+1) = k2;
+                self.hbo(end+1) = ko;
+                self.hbr(end+1) = kr;
+            end
+
+            % distance per devch (scalar = same for all)
+            dist = cfg.distance;
+            if isscalar(dist)
+                dist = repmat(dist, 1, numel(self.wl1));
+            else
+                dist = dist(devch(self.wl1));
+            end
+            dpf = cfg.dpf;
+            if isscalar(dpf), dpf = [dpf dpf]; end
+            self.scale = 1 ./ ([dpf(1); dpf(2)] .* dist(:)');
+            self.Einv  = inv(cfg.extinction);
+            self.nbase = max(round(cfg.baseline * srate), 1);
+            self.reset();
+        end
+
+        function reset(self)
+            self.I0    = zeros(2, numel(self.wl1));
+            self.count = 0;
+        end
+
+        function vec = push(self, vec)
+            %PUSH Convert one LSL sample, returns it with HbO/HbR replaced
+            if isempty(self.wl1), return; end
+            I = max([reshape(vec(self.wl1),1,[]); reshape(vec(self.wl2),1,[])], eps);
+            self.count = self.count + 1;
+            if self.count <= self.nbase
+                self.I0 = self.I0 + (I - self.I0) / self.count;
+            end
+            od = -log10(I ./ self.I0);
+            c  = 1e6 * (self.Einv * (od .* self.scale));
+            o = self.hbo > 0;
+            r = self.hbr > 0;
+            vec(self.hbo(o)) = c(1,o);
+            vec(self.hbr(r)) = c(2,r);
+        end
+    end
+end
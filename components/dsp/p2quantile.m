@@ -0,0 +1,99 @@
+classdef p2quantile < handle
+    %P2QUANTILE Streaming quantile estimate (P² algorithm)
+    %   Jain & Chlamtac's P² estimator: five markers are moved with
+    %   piecewise-parabolic updates, so the p-quantile of a stream is
+    %   tracked in O(1) time and memory without storing or sorting the
+    %   samples.
+
+    properties
+        p           double  = 0.5;          % quantile to estimate (0-1)
+        q           double  = zeros(1,5);   % marker heights
+        n           double  = 1:5;          % marker positions
+        np          double  = zeros(1,5);   % desired marker positions
+        dn          double  = zeros(1,5);   % desired position increments
+        count       double  = 0;            % samples seen
+    end
+
+    methods
+        function self = p2quantile(p)
+            if nargin < 1, p = 0.5; end
+            self.p = p;
+            self.reset();
+        end
+
+        function reset(self)
+            p = self.p;
+            self.q     = zeros(1,5);
+            self.n     = 1:5;
+            self.np    = [1, 1+2*p, 1+4*p, 3+2*p, 5];
+            self.dn    = [0, p/2, p, (1+p)/2, 1];
+            self.count = 0;
+        end
+
+        function push(self, x)
+            %PUSH Add the values of x (any shape)
+            for v = x(:)'
+                self.count = self.count + 1;
+                if self.count <= 5
+                    self.q(self.count) = v;
+                    if self.count == 5
+                        self.q = sort(self.q);
+                    end
+                    continue;
+                end
+
+                % find cell k with q(k) <= v < q(k+1), extend extremes
+                if v < self.q(1)
+                    self.q(1) = v;
+                    k = 1;
+                elseif v >= self.q(5)
+                    self.q(5) = v;
+                    k = 4;
+                else
+                    k = find(v < self.q, 1) - 1;
+                end
+                self.n(k+1:5) = self.n(k+1:5) + 1;
+                self.np = self.np + self.dn;
+
+                % adjust the three middle markers
+                for i = 2:4
+                    d = self.np(i) - self.n(i);
+                    if (d >= 1 && self.n(i+1) - self.n(i) > 1) || ...
+                       (d <= -1 && self.n(i-1) - self.n(i) < -1)
+                        d = sign(d);
+                        qp = self.parabolic(i, d);
+                        if self.q(i-1) < qp && qp < self.q(i+1)
+                            self.q(i) = qp;
+                        else
+                            self.q(i) = self.q(i) + d * (self.q(i+d) - self.q(i)) / ...
+                                (self.n(i+d) - self.n(i));
+                        end
+                        self.n(i) = self.n(i) + d;
+                    end
+                end
+            end
+        end
+
+        function v = value(self)
+            %VALUE Current estimate (exact while fewer than 5 samples)
+            if self.count >= 5
+                v = self.q(3);
+            elseif self.count > 0
+                s = sort(self.q(1:self.count));
+                v = s(max(1, round(self.p * self.count)));
+            else
+                v = NaN;
+            end
+        end
+    end
+
+    methods (Access = private)
+        function qp = parabolic(self, i, d)
+            q = self.q;
+            n = self.n;
+            qp = q(i) + d / (n(i+1) - n(i-1)) * ( ...
+                (n(i) - n(i-1) + d) * (q(i+1) - q(i)) / (n(i+1) - n(i)) + ...
+                (n(i+1) - n(i) - d) * (q(i) - q(i-1)) / (n(i) - n(i-1)));
+        end
+    end
+end
@@ -0,0 +1,105 @@
+classdef resampler < handle
+    %RESAMPLER Streaming timestamp-driven resampling to a fixed rate
+    %   Output rows are placed at t0 + k/rate (t0 = first input
+    %   timestamp). Each output time is located between the two input
+    %   samples around it by their timestamps, so jitter and drift of
+    %   the device clock do not change the output rate. The value is a
+    %   windowed-sinc interpolation from a polyphase bank (PHASES
+    %   fractional delays, 2*half taps each); when downsampling, the
+    %   kernel is stretched to cut off at the output Nyquist frequency
+    %   (anti-aliasing). Each phase has unit DC gain.
+    %
+    %   Output lags the input by half taps (input samples). Only the
+    %   last 2*half input rows are kept.
+
+    properties (Constant)
+        PHASES      = 64;                   % fractional delays in the bank
+        ZEROS       = 8;                    % sinc zero crossings per side
+    end
+
+    properties
+        rate        double  = 1;            % output rate (Hz)
+        inrate      double  = 1;            % nominal input rate (Hz)
+        half        double  = 1;            % taps per side (input samples)
+        bank        double  = zeros(0,0);   % (PHASES+1) x (2*half) kernels
+        X           double  = zeros(0,0);   % buffered input rows
+        T           double  = zeros(0,1);   % timestamps of buffered rows
+        tnext       double  = NaN;          % time of next output row
+    end
+
+    methods
+        function self = resampler(inrate, rate, nch)
+            %RESAMPLER From nominal input rate to rate for nch columns
+            if nargin < 3, inrate = 1; rate = 1; nch = 0; end
+            self.inrate = inrate;
+            self.rate   = rate;
+            rho = min(1, rate / inrate);
+            self.half = ceil(self.ZEROS / rho);
+            m = -self.half+1:self.half;
+            f = (0:self.PHASES)' / self.PHASES;
+            tau = m - f;
+            x = rho * tau;
+            h = sin(pi*x) ./ (pi*x);
+            h(x == 0) = 1;
+            h = h .* (0.5 + 0.5*cos(pi * tau / self.half));
+            self.bank = h ./ sum(h, 2);
+            self.X = zeros(0, nch);
+        end
+
+        function reset(self)
+            self.X     = zeros(0, size(self.X, 2));
+            self.T     = zeros(0, 1);
+            self.tnext = NaN;
+        end
+
+        function [y, ty] = push(self, x, ts)
+            %PUSH Input rows x with timestamps ts, output rows due so far
+            ts = ts(:);
+            if isempty(ts)
+                y  = zeros(0, size(self.X, 2));
+                ty = zeros(0, 1);
+                return;
+            end
+            if isnan(self.tnext)
+                % pad the start with the first row (no start transient)
+                self.tnext = ts(1);
+                self.X = repmat(x(1,:), self.half, 1);
+                self.T = ts(1) - (self.half:-1:1)' / self.inrate;
+            end
+            % timestamps must increase strictly for the interval lookup
+            last = self.T(end);
+            for i = 1:numel(ts)
+                ts(i) = max(ts(i), last + 1e-9);
+                last  = ts(i);
+            end
+            self.X = [self.X; x];
+            self.T = [self.T; ts];
+
+            % output times with half input rows available after them
+            N = numel(self.T);
+            limit = self.T(N - self.half + 1);
+            K = max(ceil((limit - self.tnext) * self.rate), 0);
+            ty = self.tnext + (0:K-1)' / self.rate;
+            ty = ty(ty < limit);
+            K  = numel(ty);
+
+            y = zeros(K, size(self.X, 2));
+            if K > 0
+                j = discretize(ty, self.T);
+                f = (ty - self.T(j)) ./ (self.T(j+1) - self.T(j));
+                p = round(f * self.PHASES) + 1;
+                for k = 1:K
+                    y(k,:) = self.bank(p(k),:) * self.X(j(k)-self.half+1:j(k)+self.half,:);
+                end
+                self.tnext = ty(end) + 1 / self.rate;
+            end
+
+            % keep the rows the next output still needs
+            first = max(find(self.T <= self.tnext, 1, 'last') - self.half + 1, 1);
+            if ~isempty(first) && first > 1
+                self.X = self.X(first:end,:);
+                self.T = self.T(first:end);
+            end
+        end
+    end
+end
@@ -0,0 +1,110 @@
+classdef restbaseline < handle
+    %RESTBASELINE Resting-phase buffer with streaming amplitude and mean
+    %   The rest phase is collected into buffers preallocated from the
+    %   sample rate. From rows ampstart (15 s) on, the channel mean of
+    %   each row feeds two P² estimators for the low and high amplitude
+    %   quantiles; from rows avgstart (25 s) on it feeds a running sum
+    %   for the rest average. Both are ready when the last row arrives,
+    %   no sorting or averaging of the buffer at the end of the epoch.
+    %   With regress, the amplitude is taken from the channel mean with
+    %   the mean short channel regressed out (no intercept). The
+    %   coefficient is the least-squares fit over all rest rows so far,
+    %   so it has 15 s of data when the amplitude segment starts.
+
+    properties
+        nrest       double  = 0;            % rows until the baseline is due
+        ampstart    double  = 0;            % first row of amplitude segment
+        avgstart    double  = 0;            % first row of average segment
+        buf         double  = zeros(0,0);   % transformed rows (nrest x ch)
+        SSbuf       double  = zeros(0,0);   % short channel rows (nrest x ss)
+        count       double  = 0;            % rows pushed since reset
+        qlow        p2quantile;             % low amplitude quantile
+        qhigh       p2quantile;             % high amplitude quantile
+        avgsum      double  = 0;            % sum over average segment
+        avgcount    double  = 0;            % rows in average segment
+        regress     logical = false;        % amplitude of SS-regressed mean
+        sss         double  = 0;            % sum of squared SS means
+        sxs         double  = 0;            % sum of SS mean x channel mean
+    end
+
+    methods
+        function self = restbaseline(srate, nch, nss, regress)
+            %RESTBASELINE Rest of 30 s at srate, baseline due 5 rows early
+            if nargin < 3, srate = 0; nch = 0; nss = 0; end
+            if nargin < 4, regress = false; end
+            self.regress  = regress;
+            self.nrest    = max(floor(srate*30)-5, 0);
+            self.ampstart = floor(srate*15);
+            self.avgstart = floor(srate*25);
+            self.buf      = zeros(self.nrest, nch);
+            self.SSbuf    = zeros(self.nrest, nss);
+
+            % the former sort took the mean of ranks 10-35 from each end
+            % of the amplitude segment, i.e. around rank 22.5
+            len = max(self.nrest - self.ampstart + 1, 1);
+            p = min(max(22.5 / len, 0.01), 0.49);
+            self.qlow  = p2quantile(p);
+            self.qhigh = p2quantile(1 - p);
+        end
+
+        function push(self, y, ss)
+            %PUSH Add one transformed row y and its short channel row ss
+            self.count = self.count + 1;
+            if self.count > self.nrest
+                return;
+            end
+            self.buf(self.count,:)   = y;
+            self.SSbuf(self.count,:) = ss;
+            m = mean(y);
+            a = m;
+            if self.regress && ~isempty(ss)
+                s = mean(ss);
+                self.sss = self.sss + s*s;
+                self.sxs = self.sxs + s*m;
+                if self.sss > 0
+                    a = m - s * (self.sxs / self.sss);
+                end
+            end
+            if self.count >= self.ampstart
+                self.qlow.push(a);
+                self.qhigh.push(a);
+            end
+            if self.count >= self.avgstart
+                self.avgsum   = self.avgsum + m;
+                self.avgcount = self.avgcount + 1;
+            end
+        end
+
+        function r = due(self)
+            %DUE True on the row the baseline has to be computed
+            r = self.count == self.nrest;
+        end
+
+        function a = amplitude(self)
+            %AMPLITUDE Distance of high and low quantile of the channel mean
+            a = abs(self.qhigh.value() - self.qlow.value());
+        end
+
+        function m = restmean(self)
+            %RESTMEAN Channel mean averaged over the average segment
+            m = self.avgsum / max(self.avgcount, 1);
+        end
+
+        function [y, ss] = segment(self, first)
+            %SEGMENT Buffered rows from first to the current row
+            last = min(self.count, self.nrest);
+            y  = self.buf(first:last,:);
+            ss = self.SSbuf(first:last,:);
+        end
+
+        function reset(self)
+            self.count    = 0;
+            self.avgsum   = 0;
+            self.avgcount = 0;
+            self.sss      = 0;
+            self.sxs      = 0;
+            self.qlow.reset();
+            self.qhigh.reset();
+        end
+    end
+end
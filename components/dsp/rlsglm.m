@@ -0,0 +1,59 @@
+classdef rlsglm < handle
+    %RLSGLM Recursive least squares GLM with shared regressors
+    %   Fits y = x * B for all channels at once, where the regressor row
+    %   x (1 x p) is the same for every channel (task, short channels,
+    %   drift). The gain and inverse covariance P (p x p) are therefore
+    %   computed once per sample and only the coefficient update is per
+    %   channel, O(p^2 + p * channels) per sample. With a forgetting
+    %   factor lambda < 1 this is the Kalman filter of a random-walk
+    %   coefficient model, so slowly changing drift is tracked.
+
+    properties
+        lambda      double  = 1.0;          % forgetting factor (0-1]
+        delta       double  = 1e3;          % initial P = delta * I
+        B           double  = zeros(0,0);   % coefficients (p x channels)
+        P           double  = zeros(0,0);   % inverse covariance (p x p)
+        s2          double  = zeros(1,0);   % residual variance per channel
+        count       double  = 0;            % samples fitted
+    end
+
+    methods
+        function self = rlsglm(p, nch, lambda, delta)
+            %RLSGLM p regressors, nch channels
+            if nargin < 2, p = 0; nch = 0; end
+            if nargin >= 3, self.lambda = lambda; end
+            if nargin >= 4, self.delta  = delta;  end
+            self.B  = zeros(p, nch);
+            self.P  = zeros(p, p);
+            self.s2 = zeros(1, nch);
+            self.reset();
+        end
+
+        function reset(self)
+            p = size(self.B, 1);
+            self.B(:)  = 0;
+            self.P     = self.delta * eye(p);
+            self.s2(:) = 0;
+            self.count = 0;
+        end
+
+        function e = push(self, x, y)
+            %PUSH Fit row x (1 x p) to y (1 x channels), a priori error e
+            Px = self.P * x';
+            k  = Px / (self.lambda + x * Px);
+            e  = y - x * self.B;
+            self.B = self.B + k * e;
+            self.P = (self.P - k * Px') / self.lambda;
+            self.P = (self.P + self.P') / 2;
+            % residual variance: running mean first, then forgetting
+            self.count = self.count + 1;
+            w = max(1 - self.lambda, 1 / self.count);
+            self.s2 = (1 - w) * self.s2 + w * e.^2;
+        end
+
+        function z = tstat(self, j)
+            %TSTAT t-like statistic of coefficient j per channel
+            z = self.B(j,:) ./ sqrt(max(self.s2 * self.P(j,j), eps));
+        end
+    end
+end
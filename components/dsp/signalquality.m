@@ -0,0 +1,143 @@
+classdef signalquality < handle
+    %SIGNALQUALITY Streaming per-channel NIRS signal quality
+    %   Works on the raw intensities of two wavelengths per
+    %   source-detector pair (devch), updated for every sample:
+    %
+    %   - scalp coupling index (SCI): correlation of both wavelengths
+    %     in the cardiac band (0.5-2.5 Hz) over the last window seconds,
+    %     a coupled optode shows the same heart beat in both
+    %   - coefficient of variation (CV, %) of the intensities
+    %   - saturation: share of samples at or above the saturation level
+    %     (or at/below zero)
+    %
+    %   A pair is good if sci >= minsci, cv <= maxcv and no sample in
+    %   the window saturated. Its weight is min(sci/minsci, 1) if the
+    %   CV and saturation checks pass, 0 otherwise. push() returns mask
+    %   and weight per LSL column, all columns of a devch (HbO, HbR,
+    %   wavelengths) share the value of their pair. Columns without a
+    %   wavelength pair, and all columns during the first half window,
+    %   count as good. O(channels) per sample.
+
+    properties
+        wl1         double  = zeros(1,0);   % sample index of 1st wavelength
+        wl2         double  = zeros(1,0);   % sample index of 2nd wavelength
+        devch       double  = zeros(1,0);   % devch of each pair
+        colpair     double  = zeros(1,0);   % pair of each LSL column (0 = none)
+        minsci      double  = 0.75;         % SCI threshold
+        maxcv       double  = 7.5;          % CV threshold (%)
+        saturation  double  = Inf;          % saturation level (intensity)
+        warmup      double  = 0;            % rows before checks apply
+        count       double  = 0;            % rows seen
+        Cardiac     = [];                   % sosfilter on both wavelengths ([] = no SCI)
+        Corr        slidingcorr;            % SCI per pair
+        Level       slidingwindow;          % intensity window (CV)
+        Clip        slidingwindow;          % saturated flags window
+        sci         double  = zeros(1,0);   % last SCI per pair
+        cv          double  = zeros(1,0);   % last CV per pair (%, worse wavelength)
+        saturated   double  = zeros(1,0);   % last saturated share per pair
+        good        logical = false(1,0);   % last mask per pair
+        weight      double  = zeros(1,0);   % last weight per pair
+    end
+
+    methods
+        function self = signalquality(channels, cfg, srate)
+            %SIGNALQUALITY From device.lsl.channels and device.quality
+            if nargin < 3, return; end
+            ch    = channels(:)';
+            types = string({ch.type});
+            devch = double([ch.devch]);
+            for k = find(types == cfg.wavelengths(1))
+                k2 = find(types == cfg.wavelengths(2) & devch == devch(k), 1);
+                if isempty(k2), continue; end
+                self.wl1(end+1)   = k;
+                self.wl2(end+1)   = k2;
+                self.devch(end+1) = devch(k);
+            end
+            self.colpair = zeros(1, numel(ch));
+            for p = 1:numel(self.devch)
+                self.colpair(devch == self.devch(p)) = p;
+            end
+            self.minsci     = cfg.sci;
+            self.maxcv      = cfg.cv;
+            self.saturation = cfg.saturation;
+
+            np  = numel(self.devch);
+            len = max(round(cfg.window * srate), 2);
+            self.warmup = max(ceil(len / 2), 2);
+            self.Corr   = slidingcorr(len, np);
+            self.Level  = slidingwindow(len, 2*np);
+            self.Clip   = slidingwindow(len, np);
+            % cardiac band needs a sample rate well above 2*2.5 Hz
+            if srate >= 6
+                self.Cardiac = sosfilter( ...
+                    butterworth(2, [0.5 2.5], srate, "bandpass"), 2*np, 1);
+            else
+                warning("signalquality: %.1f Hz is too slow for the SCI, using CV and saturation only", srate);
+            end
+            self.reset();
+        end
+
+        function reset(self)
+            np = numel(self.devch);
+            self.count     = 0;
+            self.sci       = ones(1, np);
+            self.cv        = zeros(1, np);
+            self.saturated = zeros(1, np);
+            self.good      = true(1, np);
+            self.weight    = ones(1, np);
+            self.Corr.reset();
+            self.Level.reset();
+            self.Clip.reset();
+            if ~isempty(self.Cardiac)
+                self.Cardiac.reset();
+            end
+        end
+
+        function [mask, w] = push(self, block)
+            %PUSH Raw LSL rows (n x columns), mask/weight per row and column
+            n  = size(block, 1);
+            np = numel(self.devch);
+            mask = true(n, numel(self.colpair));
+            w    = ones(n, numel(self.colpair));
+            if np == 0 || n == 0, return; end
+
+            I = [block(:,self.wl1), block(:,self.wl2)];
+            clip = I >= self.saturation | I <= 0;
+            clip = clip(:,1:np) | clip(:,np+1:end);
+            if ~isempty(self.Cardiac)
+                F = self.Cardiac.push(I);
+            end
+            has = self.colpair > 0;
+            for i = 1:n
+                self.count = self.count + 1;
+                self.Level.push(I(i,:));
+                self.Clip.push(double(clip(i,:)));
+                if ~isempty(self.Cardiac)
+                    self.Corr.push(F(i,1:np), F(i,np+1:end));
+                end
+                if self.count < self.warmup, continue; end
+                self.evaluate();
+                mask(i,has) = self.good(self.colpair(has));
+                w(i,has)    = self.weight(self.colpair(has));
+            end
+        end
+    end
+
+    methods (Access = private)
+        function evaluate(self)
+            %EVALUATE Current SCI, CV, saturation, mask and weight per pair
+            np = numel(self.devch);
+            if ~isempty(self.Cardiac)
+                self.sci = self.Corr.corr();
+            end
+            m  = self.Level.stats.mean();
+            sd = sqrt(max(self.Level.stats.var(), 0));
+            cv = 100 * sd ./ max(abs(m), eps);
+            self.cv        = max(cv(1:np), cv(np+1:end));
+            self.saturated = self.Clip.mean();
+            ok = self.cv <= self.maxcv & self.saturated == 0;
+            self.good   = ok & self.sci >= self.minsci;
+            self.weight = ok .* min(max(self.sci / self.minsci, 0), 1);
+        end
+    end
+end
@@ -0,0 +1,102 @@
+classdef slidingcorr < handle
+    %SLIDINGCORR Pearson correlation of signal pairs over a sliding window
+    %   For each pair the sums of a, b, a^2, b^2 and a*b over the last
+    %   len samples are updated by adding the new and subtracting the
+    %   leaving sample (kept in a ring), so r is exact at O(pairs) per
+    %   sample. Sums are recomputed from the ring once per window length
+    %   to avoid drift.
+
+    properties
+        len         double  = 0;            % window length (rows)
+        count       double  = 0;            % rows currently in window
+        head        double  = 0;            % last written row in rings
+        pushes      double  = 0;            % pushes since last resync
+        A           double  = zeros(0,0);   % ring of first signals
+        B           double  = zeros(0,0);   % ring of second signals
+        sa          double  = zeros(1,0);   % sum a
+        sb          double  = zeros(1,0);   % sum b
+        saa         double  = zeros(1,0);   % sum a^2
+        sbb         double  = zeros(1,0);   % sum b^2
+        sab         double  = zeros(1,0);   % sum a*b
+    end
+
+    methods
+        function self = slidingcorr(len, npairs)
+            if nargin < 2, len = 0; npairs = 0; end
+            self.len = len;
+            self.A   = zeros(len, npairs);
+            self.B   = zeros(len, npairs);
+            self.reset();
+        end
+
+        function reset(self)
+            k = size(self.A, 2);
+            self.count  = 0;
+            self.head   = 0;
+            self.pushes = 0;
+            self.A(:)   = 0;
+            self.B(:)   = 0;
+            self.sa     = zeros(1, k);
+            self.sb     = zeros(1, k);
+            self.saa    = zeros(1, k);
+            self.sbb    = zeros(1, k);
+            self.sab    = zeros(1, k);
+        end
+
+        function push(self, a, b)
+            %PUSH Add rows a, b (n x pairs)
+            for i = 1:size(a,1)
+                self.head = mod(self.head, self.len) + 1;
+                if self.count == self.len
+                    oa = self.A(self.head,:);
+                    ob = self.B(self.head,:);
+                    self.sa  = self.sa  - oa;
+                    self.sb  = self.sb  - ob;
+                    self.saa = self.saa - oa.^2;
+                    self.sbb = self.sbb - ob.^2;
+                    self.sab = self.sab - oa.*ob;
+                else
+                    self.count = self.count + 1;
+                end
+                self.A(self.head,:) = a(i,:);
+                self.B(self.head,:) = b(i,:);
+                self.sa  = self.sa  + a(i,:);
+                self.sb  = self.sb  + b(i,:);
+                self.saa = self.saa + a(i,:).^2;
+                self.sbb = self.sbb + b(i,:).^2;
+                self.sab = self.sab + a(i,:).*b(i,:);
+
+                self.pushes = self.pushes + 1;
+                if self.pushes >= self.len
+                    self.resync();
+                end
+            end
+        end
+
+        function r = corr(self)
+            %CORR Correlation per pair (NaN while fewer than 2 rows)
+            n = self.count;
+            cab = n*self.sab - self.sa.*self.sb;
+            caa = n*self.saa - self.sa.^2;
+            cbb = n*self.sbb - self.sb.^2;
+            r = cab ./ sqrt(max(caa.*cbb, eps));
+            if n < 2
+                r(:) = NaN;
+            end
+        end
+    end
+
+    methods (Access = private)
+        function resync(self)
+            rows = 1:self.count;
+            a = self.A(rows,:);
+            b = self.B(rows,:);
+            self.sa  = sum(a, 1);
+            self.sb  = sum(b, 1);
+            self.saa = sum(a.^2, 1);
+            self.sbb = sum(b.^2, 1);
+            self.sab = sum(a.*b, 1);
+            self.pushes = 0;
+        end
+    end
+end
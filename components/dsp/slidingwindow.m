@@ -0,0 +1,80 @@
+classdef slidingwindow < handle
+    %SLIDINGWINDOW Ring buffer of the last len rows with running stats
+    %   push() appends new rows (n x channels) and keeps a windowstats
+    %   instance up to date with the rows entering and leaving, so the
+    %   moving average/variance is O(channels) per sample.
+
+    properties
+        ring        double  = zeros(0,0);   % window rows (ring buffer)
+        head        uint32  = 0;            % last written row in ring
+        count       uint32  = 0;            % valid rows in ring
+        stats       windowstats;            % running stats of ring
+    end
+
+    methods
+        function self = slidingwindow(len, nch)
+            if nargin < 2, len = 0; nch = 0; end
+            self.ring  = zeros(len, nch);
+            self.stats = windowstats(len, nch);
+        end
+
+        function m = push(self, x, need)
+            %PUSH Append block x (n x channels)
+            %   Optional m (n x 1) is the mean over all rows and channels
+            %   of the window after each row of x, read from the running
+            %   stats while the rows go in. With logical need (n x 1) only
+            %   rows with need(i) get a mean, the others are NaN.
+            len = size(self.ring, 1);
+            n   = size(x,1);
+            first = max(1, n-len+1);
+            if nargout > 0
+                if nargin < 3, need = true(n, 1); end
+                m = nan(n, 1);
+                if any(need)
+                    % earlier rows are needed for the means in between
+                    first = 1;
+                end
+            end
+            for i = first:n
+                self.head = mod(self.head, len) + 1;
+                if self.count < len
+                    self.count = self.count + 1;
+                    self.stats.push(x(i,:));
+                else
+                    self.stats.push(x(i,:), self.ring(self.head,:));
+                end
+                self.ring(self.head,:) = x(i,:);
+                if nargout > 0 && need(i)
+                    m(i) = self.stats.grandmean();
+                end
+            end
+        end
+
+        function w = window(self)
+            %WINDOW Window rows, oldest first
+            len = size(self.ring, 1);
+            if self.count < len
+                w = self.ring(1:self.count,:);
+            else
+                w = self.ring([self.head+1:len, 1:self.head],:);
+            end
+        end
+
+        function m = mean(self)
+            %MEAN Mean per channel
+            m = self.stats.mean();
+        end
+
+        function m = grandmean(self)
+            %GRANDMEAN Mean over all rows and channels
+            m = self.stats.grandmean();
+        end
+
+        function reset(self)
+            self.ring(:) = 0;
+            self.head    = 0;
+            self.count   = 0;
+            self.stats.reset();
+        end
+    end
+end
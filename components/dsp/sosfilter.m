@@ -0,0 +1,60 @@
+classdef sosfilter < iirfilter
+    %SOSFILTER Stateful multi-channel biquad cascade over a sliding window
+    %   Same streaming contract as iirfilter (push new samples, filtered
+    %   window in a ring with running stats), but evaluated as a cascade
+    %   of second-order sections, which stays numerically stable for
+    %   low cutoffs such as 0.01 Hz at 10 Hz. Create sections with
+    %   butterworth(). Each section is primed to its steady state.
+
+    properties
+        sos         double  = zeros(0,6);   % sections [b0 b1 b2 1 a1 a2]
+        zs          double  = zeros(2,0,0); % state (2 x channels x sections)
+        zsss        double  = zeros(2,0);   % steady-state per section
+    end
+
+    methods
+        function self = sosfilter(sos, nch, windowsize)
+            %SOSFILTER Create cascade for nch channels and window length
+            self@iirfilter(1, 1, nch, windowsize);
+            nsec      = size(sos, 1);
+            self.sos  = sos ./ sos(:,4);
+            self.zs   = zeros(2, nch, nsec);
+            self.zsss = zeros(2, nsec);
+            for s = 1:nsec
+                self.zsss(:,s) = iirfilter.steadystate( ...
+                    self.sos(s,1:3), self.sos(s,4:6));
+            end
+        end
+
+        function reset(self)
+            reset@iirfilter(self);
+            self.zs(:) = 0;
+        end
+    end
+
+    methods (Access = protected)
+        function y = step(self, x)
+            %STEP Run x through all sections, keeping their states
+            %   Large blocks are split over channels (channelpool).
+            sos  = self.sos;
+            zsss = self.zsss;
+            prime = ~self.primed;
+            [y, self.zs] = channelpool.shared().run( ...
+                @(x, z) sosfilter.cascade(sos, zsss, prime, x, z), x, self.zs);
+            self.primed = true;
+        end
+    end
+
+    methods (Static)
+        function [y, zs] = cascade(sos, zsss, prime, x, zs)
+            %CASCADE Sections in sequence on x, states zs (2 x ch x sec)
+            y = x;
+            for s = 1:size(sos, 1)
+                if prime
+                    zs(:,:,s) = zsss(:,s) * y(1,:);
+                end
+                [y, zs(:,:,s)] = filter(sos(s,1:3), sos(s,4:6), y, zs(:,:,s));
+            end
+        end
+    end
+end
@@ -0,0 +1,69 @@
+classdef spatialfilter < handle
+    %SPATIALFILTER Streaming spatial filter over the channels of one type
+    %   "car": common average reference, y = x - mean(x).
+    %   "pca": global signal removal, y = x - (x - mu) * U * U', where U
+    %   holds the ncomp leading eigenvectors of an exponentially weighted
+    %   covariance. The covariance is updated with every block; U is only
+    %   refreshed every refresh samples (eig is the expensive part), so
+    %   per sample the projection costs two small matrix-vector products.
+
+    properties
+        method      string  = "car";        % "car" | "pca"
+        ncomp       double  = 1;            % components removed (pca)
+        alpha       double  = 0;            % covariance update weight
+        refresh     double  = 1;            % samples between eig updates
+        since       double  = 0;            % samples since last eig update
+        count       double  = 0;            % samples seen
+        mu          double  = zeros(1,0);   % weighted mean
+        C           double  = zeros(0,0);   % weighted covariance
+        U           double  = zeros(0,0);   % removed components (ch x ncomp)
+    end
+
+    methods
+        function self = spatialfilter(method, nch, srate, ncomp, tau, refresh)
+            %SPATIALFILTER tau: covariance memory (s), refresh: eig period (s)
+            if nargin < 3, method = "car"; nch = 0; srate = 1; end
+            if nargin < 4, ncomp = 1; end
+            if nargin < 5, tau = 60; end
+            if nargin < 6, refresh = 10; end
+            self.method  = lower(string(method));
+            if ~any(self.method == ["car", "pca"])
+                error('spatialfilter:BadMethod', 'Unknown spatial filter "%s"', method);
+            end
+            self.ncomp   = min(ncomp, nch);
+            self.alpha   = 1 / max(tau * srate, 1);
+            self.refresh = max(round(refresh * srate), 1);
+            self.mu      = zeros(1, nch);
+            self.C       = zeros(nch, nch);
+            self.U       = zeros(nch, 0);
+        end
+
+        function Y = push(self, X)
+            %PUSH Filter block X (n x channels)
+            if self.method == "car"
+                Y = X - mean(X, 2);
+                return;
+            end
+
+            % exponentially weighted mean/covariance over the block
+            n = size(X, 1);
+            for i = 1:n
+                self.count = self.count + 1;
+                a = max(self.alpha, 1 / self.count);
+                d = X(i,:) - self.mu;
+                self.mu = self.mu + a * d;
+                self.C  = (1 - a) * (self.C + a * (d' * d));
+            end
+            self.since = self.since + n;
+            if self.since >= self.refresh && self.count > size(X,2)
+                self.since = 0;
+                [V, D] = eig((self.C + self.C') / 2);
+                [~, o] = sort(diag(D), 'descend');
+                self.U = V(:, o(1:self.ncomp));
+            end
+
+            % remove the leading components
+            Y = X - ((X - self.mu) * self.U) * self.U';
+        end
+    end
+end
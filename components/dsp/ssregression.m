@@ -0,0 +1,117 @@
+classdef ssregression < handle
+    %SSREGRESSION Sliding-window short-separation regression
+    %   Keeps the cross-products between the long channels X and the
+    %   short-channel regressors S over the last len samples, updated by
+    %   adding the new sample and removing the one leaving the window:
+    %
+    %       beta = (S'S) \ (S'X)        (k x channels, no intercept)
+    %       corrected mean = mean(X) - mean(S) * beta
+    %
+    %   With mode "mean" the regressor is the mean of all short channels
+    %   (k = 1, one dot product pair per channel as before). With mode
+    %   "each" every short channel is its own regressor (k = #SS), which
+    %   is the exact sliding-window form of recursive least squares.
+    %   Per sample cost is O(k * channels + k^2); sums are recomputed
+    %   from the ring once per window length to avoid drift.
+
+    properties
+        mode        string  = "mean";       % "mean" | "each"
+        len         uint32  = 0;            % window length (rows)
+        count       uint32  = 0;            % rows currently in window
+        head        uint32  = 0;            % last written row in rings
+        pushes      uint32  = 0;            % pushes since last resync
+        X           double  = zeros(0,0);   % ring of long channels
+        S           double  = zeros(0,0);   % ring of regressors
+        StS         double  = zeros(0,0);   % S'S   (k x k)
+        StX         double  = zeros(0,0);   % S'X   (k x channels)
+        sumX        double  = zeros(1,0);   % column sums of X
+        sumS        double  = zeros(1,0);   % column sums of S
+    end
+
+    methods
+        function self = ssregression(len, nch, nss, mode)
+            %SSREGRESSION len rows, nch long and nss short channels
+            if nargin < 4, mode = "mean"; end
+            self.mode = mode;
+            self.len  = len;
+            if self.mode == "each"
+                k = nss;
+            else
+                k = 1;
+            end
+            self.X = zeros(len, nch);
+            self.S = zeros(len, k);
+            self.reset();
+        end
+
+        function reset(self)
+            k = size(self.S, 2);
+            self.count  = 0;
+            self.head   = 0;
+            self.pushes = 0;
+            self.X(:)   = 0;
+            self.S(:)   = 0;
+            self.StS    = zeros(k, k);
+            self.StX    = zeros(k, size(self.X, 2));
+            self.sumX   = zeros(1, size(self.X, 2));
+            self.sumS   = zeros(1, k);
+        end
+
+        function push(self, x, ss)
+            %PUSH Add one sample: x long channels, ss short channels
+            if self.mode == "each"
+                s = ss;
+            else
+                s = mean(ss);
+            end
+            self.head = mod(self.head, self.len) + 1;
+            if self.count < self.len
+                self.count = self.count + 1;
+            else
+                xo = self.X(self.head,:);
+                so = self.S(self.head,:);
+                self.StS  = self.StS  - so' * so;
+                self.StX  = self.StX  - so' * xo;
+                self.sumX = self.sumX - xo;
+                self.sumS = self.sumS - so;
+            end
+            self.X(self.head,:) = x;
+            self.S(self.head,:) = s;
+            self.StS  = self.StS  + s' * s;
+            self.StX  = self.StX  + s' * x;
+            self.sumX = self.sumX + x;
+            self.sumS = self.sumS + s;
+
+            % exact recompute once per window length
+            self.pushes = self.pushes + 1;
+            if self.pushes >= self.len
+                self.resync();
+            end
+        end
+
+        function b = beta(self)
+            %BETA Regression weights (k x channels)
+            k = size(self.StS, 1);
+            b = (self.StS + eps(max(trace(self.StS), 1)) * eye(k)) \ self.StX;
+        end
+
+        function m = correctedmean(self)
+            %CORRECTEDMEAN Window mean per channel after regression
+            n = max(double(self.count), 1);
+            m = self.sumX / n - (self.sumS / n) * self.beta();
+        end
+    end
+
+    methods (Access = private)
+        function resync(self)
+            n = double(self.count);
+            X = self.X(1:n,:);
+            S = self.S(1:n,:);
+            self.StS  = S' * S;
+            self.StX  = S' * X;
+            self.sumX = sum(X, 1);
+            self.sumS = sum(S, 1);
+            self.pushes = 0;
+        end
+    end
+end
@@ -0,0 +1,104 @@
+classdef windowstats < handle
+    %WINDOWSTATS Running mean/variance per channel over a sliding window
+    %   The caller passes each new row together with the row leaving the
+    %   window ([] while the window is filling up). Sums are kept with
+    %   compensated (Kahan) accumulation on data shifted by the first
+    %   sample, so add/remove over long sessions does not drift and the
+    %   variance does not suffer from cancellation. All updates and
+    %   queries are O(channels), independent of the window length.
+    %   Protocols get window means through their own slidingwindow
+    %   (which keeps one of these) rather than from the session, since
+    %   the v2 protocols evaluate blocks of rows and need the mean after
+    %   each row, not only the latest one.
+
+    properties
+        len         uint32  = 0;            % window length (rows)
+        count       uint32  = 0;            % rows currently in window
+        shift       double  = zeros(1,0);   % first sample (per channel)
+        sx          double  = zeros(1,0);   % sum of shifted values
+        sxc         double  = zeros(1,0);   % Kahan compensation of sx
+        sxx         double  = zeros(1,0);   % sum of squared shifted values
+        sxxc        double  = zeros(1,0);   % Kahan compensation of sxx
+    end
+
+    methods
+        function self = windowstats(len, nch)
+            if nargin < 2, len = 0; nch = 0; end
+            self.len = len;
+            self.reset(nch);
+        end
+
+        function reset(self, nch)
+            if nargin < 2, nch = numel(self.sx); end
+            self.count  = 0;
+            self.shift  = [];
+            self.sx     = zeros(1, nch);
+            self.sxc    = zeros(1, nch);
+            self.sxx    = zeros(1, nch);
+            self.sxxc   = zeros(1, nch);
+        end
+
+        function push(self, new, old)
+            %PUSH Add row new, remove row old (omit/[] if window not full)
+            if isempty(self.shift)
+                self.shift = new;
+            end
+            x = new - self.shift;
+            [self.sx,  self.sxc]  = windowstats.kahan(self.sx,  self.sxc,  x);
+            [self.sxx, self.sxxc] = windowstats.kahan(self.sxx, self.sxxc, x.^2);
+            if nargin > 2 && ~isempty(old)
+                x = old - self.shift;
+                [self.sx,  self.sxc]  = windowstats.kahan(self.sx,  self.sxc,  -x);
+                [self.sxx, self.sxxc] = windowstats.kahan(self.sxx, self.sxxc, -x.^2);
+            elseif self.count < self.len
+                self.count = self.count + 1;
+            end
+        end
+
+        function m = mean(self)
+            %MEAN Mean per channel (1 x channels)
+            n = max(double(self.count), 1);
+            m = self.sx / n;
+            if ~isempty(self.shift)
+                m = m + self.shift;
+            end
+        end
+
+        function v = var(self)
+            %VAR Sample variance per channel (1 x channels)
+            n = double(self.count);
+            if n < 2
+                v = zeros(size(self.sx));
+                return;
+            end
+            v = max((self.sxx - self.sx.^2 / n) / (n - 1), 0);
+        end
+
+        function m = grandmean(self)
+            %GRANDMEAN Mean over all channels and rows
+            m = mean(self.mean());
+        end
+
+        function v = grandvar(self)
+            %GRANDVAR Variance over all rows and channels pooled
+            n = double(self.count) * numel(self.sx);
+            if n < 2
+                v = 0;
+                return;
+            end
+            total = sum(self.sx + double(self.count) * self.shift);
+            totalsq = sum(self.sxx + 2 * self.shift .* self.sx + ...
+                          double(self.count) * self.shift.^2);
+            v = max((totalsq - total^2 / n) / (n - 1), 0);
+        end
+    end
+
+    methods (Static)
+        function [s, c] = kahan(s, c, v)
+            y = v - c;
+            t = s + y;
+            c = (t - s) - y;
+            s = t;
+        end
+    end
+end
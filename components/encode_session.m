@@ -0,0 +1,72 @@
+function out = encode_session(export)
+%ENCODE_SESSION Convert a session snapshot to the compact storage profile.
+%
+% out = encode_session(export)
+%
+% Changes against the full profile:
+%   data, processed, SSdata        : single instead of double
+%   window, SSwindow               : single
+%   rawFeedback, normFeedback      : single
+%   markers                        : uint8, or uint16 if any is above 255
+%   runType                        : logical out.transfer (true = transfer)
+%   times                          : struct with fields
+%       start       : first timestamp (s)
+%       rate        : fitted sample rate (Hz)
+%       residual_us : int32 jitter against start + (k-1)/rate (µs)
+%
+% Notes:
+% - out.format = "compact-v1"; decode_session() restores the full layout.
+% - Timestamps are exact to 1 µs, samples to float32 precision.
+% - Markers must be integers in 0-65535; others raise an error instead
+%   of being saturated.
+
+    out = export;
+    out.format = "compact-v1";
+
+    % samples as float32
+    for f = ["data", "processed", "SSdata", "window", "SSwindow"]
+        if ~isfield(out, f), continue; end
+        types = fieldnames(out.(f));
+        for k = 1:numel(types)
+            out.(f).(types{k}) = single(out.(f).(types{k}));
+        end
+    end
+    out.rawFeedback  = single(out.rawFeedback);
+    out.normFeedback = single(out.normFeedback);
+
+    % markers and run type
+    m = double(out.markers);
+    if any(m < 0 | m > intmax('uint16') | m ~= round(m))
+        error("encode_session:markers", ...
+            "markers must be integers in 0-65535 for compact storage");
+    end
+    if any(m > intmax('uint8'))
+        out.markers = uint16(m);
+    else
+        out.markers = uint8(m);
+    end
+    out.transfer = strcmp(out.runType, 'transfer');
+    out = rmfield(out, 'runType');
+
+    % timestamps: linear fit plus residuals
+    times = double(export.times(:));
+    n     = numel(times);
+    start = 0.0;
+    rate  = double(export.samplerate);
+    if n > 0
+        start = times(1);
+    end
+    if n > 1
+        k = (0:n-1)';
+        p = [k ones(n,1)] \ (times - start);
+        if p(1) > 0
+            rate  = 1.0 / p(1);
+            start = start + p(2);
+        end
+    end
+    expected = start + (0:n-1)' / rate;
+    out.times = struct( ...
+        'start',       start, ...
+        'rate',        rate, ...
+        'residual_us', int32(round((times - expected) * 1e6)));
+end
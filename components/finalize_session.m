@@ -0,0 +1,40 @@
+function finalize_session(export, matPath, pngPath, finish, queue)
+%FINALIZE_SESSION Write a session snapshot, render and export its plot.
+%
+% finalize_session(export, matPath, pngPath, finish, queue)
+%
+% Inputs:
+%   export  : struct from session.snapshot()
+%   matPath : reserved .mat file name
+%   pngPath : reserved .png file name
+%   finish  : protocol finish handle, called with the snapshot
+%   queue   : parallel.pool.DataQueue for progress, [] when synchronous
+%
+% Notes:
+% - Runs on a pool worker (see finalizer) or on the client as fallback.
+% - On a worker the plot is rendered offscreen.
+
+    [~, name] = fileparts(matPath);
+    onWorker  = ~isempty(queue);
+
+    progress(queue, "Writing " + name);
+    write_session(export, matPath);
+
+    progress(queue, "Plotting " + name);
+    if onWorker
+        set(groot, 'DefaultFigureVisible', 'off');
+    end
+    finish(export);
+    save_session_plot(export, pngPath);
+    if onWorker
+        close(findobj(groot, 'Type', 'figure', 'Name', 'Session Plot'));
+    end
+
+    progress(queue, "Saved " + name);
+end
+
+function progress(queue, msg)
+    if ~isempty(queue)
+        send(queue, msg);
+    end
+end
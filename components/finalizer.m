@@ -0,0 +1,107 @@
+classdef finalizer < handle
+    %FINALIZER Saves, plots and exports stopped sessions in the background
+    %   A snapshot of the session is taken on the UI thread, everything
+    %   else (writing the .mat, running the protocol's finish, exporting
+    %   the plot) runs on a parallel worker so the next run can be started
+    %   while the previous one is still being written. Without the
+    %   Parallel Computing Toolbox the same steps run synchronously.
+
+    properties
+        pool                            % parallel pool used for jobs ([] = sync)
+        queue                           % DataQueue receiving progress messages
+        futures                         % jobs still running (FevalFuture)
+        names       string  = strings(0,1); % file name per running job
+        status      string  = "";       % last progress message
+        failed      uint32  = 0;        % number of failed jobs
+    end
+
+    methods
+        function self = finalizer()
+            %FINALIZER Use an existing or new process pool if available
+            self.pool = [];
+            if isempty(ver('parallel')) || ~license('test', 'Distrib_Computing_Toolbox')
+                return;
+            end
+            try
+                % graphics need a process (not thread) based worker; an
+                % open thread pool blocks a new one, so finalize in the
+                % foreground then
+                p = gcp('nocreate');
+                if isempty(p)
+                    p = parpool('Processes', 1);
+                elseif ~isa(p, 'parallel.ProcessPool') && ~isa(p, 'parallel.ClusterPool')
+                    warning('finalizer:NoProcessPool', ...
+                        'Finalizing sessions synchronously: open %s cannot plot', class(p));
+                    return;
+                end
+                self.pool  = p;
+                self.queue = parallel.pool.DataQueue;
+                afterEach(self.queue, @(msg) self.onProgress(msg));
+            catch err
+                warning('finalizer:NoPool', ...
+                    'Finalizing sessions synchronously: %s', err.message);
+                self.pool = [];
+            end
+        end
+
+        function r = pending(self)
+            r = numel(self.futures);
+        end
+
+        function submit(self, session, finish)
+            %SUBMIT Snapshot the session and finalize it in the background
+            %   finish is the protocol's finish handle (protocols.finisher)
+            export  = session.snapshot();
+            matPath = session.filepath(".mat");
+            pngPath = session.filepath(".png");
+            [~, name] = fileparts(matPath);
+            if isempty(self.pool)
+                self.status = "Saving " + name;
+                finalize_session(export, matPath, pngPath, finish, []);
+                self.status = "Saved " + name;
+                return;
+            end
+            f = parfeval(self.pool, @finalize_session, 0, ...
+                export, matPath, pngPath, finish, self.queue);
+            self.futures(end+1) = f;
+            self.names(end+1)   = name;
+            self.status = "Queued " + name;
+        end
+
+        function update(self)
+            %UPDATE Collect finished jobs and report their outcome
+            k = 1;
+            while k <= numel(self.futures)
+                f = self.futures(k);
+                if f.State ~= "finished"
+                    k = k + 1;
+                    continue;
+                end
+                if ~isempty(f.Error)
+                    self.failed = self.failed + 1;
+                    self.status = "FAILED " + self.names(k);
+                    warning('finalizer:Failed', 'Finalizing %s failed: %s', ...
+                        self.names(k), f.Error.message);
+                else
+                    self.status = "Saved " + self.names(k);
+                end
+                self.futures(k) = [];
+                self.names(k)   = [];
+            end
+        end
+
+        function wait(self)
+            %WAIT Block until all jobs are done (e.g. on shutdown)
+            if ~isempty(self.futures)
+                wait(self.futures);
+            end
+            self.update();
+        end
+    end
+
+    methods (Access = private)
+        function onProgress(self, msg)
+            self.status = string(msg);
+        end
+    end
+end
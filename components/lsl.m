@@ -20,14 +20,21 @@ classdef lsl < handle
         sample      double    = zeros(0);     % last sample (NF)
         SSsample    double    = zeros(0);     % last sample (SS)
         timestamp   double    = 0.0;          % last sample timestamp
+        chunk       double    = zeros(0,0);   % samples pulled in last update (NF)
+        SSchunk     double    = zeros(0,0);   % samples pulled in last update (SS)
+        timestamps  double    = zeros(0,1);   % timestamps of chunk rows
         outtrigger  lsl_outlet;               % outlet for trigger
         outmarker   lsl_outlet;               % outlet for marker
         marker      double    = 0.0;          % current epoch marker
+        converter   = [];                     % mbll on raw wavelengths ([] = off)
+        monitor     = [];                     % signalquality on raw wavelengths ([] = off)
+        resampler   = [];                     % resampler to the processing rate ([] = off)
+        weightchunk double    = zeros(0,0);   % quality weight of chunk rows (NF)
         N           (1,1) uint32 = 0          % number of channels per block inferred from LSL
     end
     
     events
-        NewSample
+        NewChunk
     end
     
     methods
@@ -45,6 +52,7 @@ classdef lsl < handle
         function reset(self, rows, channels, SSchannels)
             %RESET  Configure which channels to read (NF & SS)
             global myprotocols;
+            global mydevices;
             
             % Validate number of rows
             rows = ceil(rows);
@@ -91,8 +99,43 @@ classdef lsl < handle
                 self.SSchannels = [];
                 self.SSsample   = zeros(1, 0);
             end
+
+            % HbO/HbR computed here from raw wavelengths (optional)
+            self.converter = [];
+            device = mydevices.selected;
+            if ~isempty(device) && isfield(device, 'mbll') && device.mbll.enabled
+                self.converter = mbll(device.lsl.channels, device.mbll, ...
+                    max(self.sratenom, self.srate));
+            end
+
+            % Fixed processing rate (optional)
+            self.resampler = [];
+            if ~isempty(device) && isfield(device, 'resample') && device.resample.enabled
+                self.resampler = resampler(max(self.sratenom, self.srate), ...
+                    device.resample.rate, self.lslchannels + nNF);
+            end
+
+            % Signal quality of the raw wavelengths (optional)
+            self.monitor = [];
+            if ~isempty(device) && isfield(device, 'quality') && device.quality.enabled
+                self.monitor = signalquality(device.lsl.channels, device.quality, ...
+                    max(self.sratenom, self.srate));
+            end
         end
         
+        function r = processingrate(self)
+            %PROCESSINGRATE Rate of the chunks handed to the session
+            global mydevices;
+            device = mydevices.selected;
+            if ~isempty(device) && isfield(device, 'resample') && device.resample.enabled
+                r = device.resample.rate;
+            elseif self.sratenom > 0
+                r = self.sratenom; % prefer claimed samplerate
+            else
+                r = self.srate;    % else use measured
+            end
+        end
+
         function r = open(self, type)
             self.streams = lsl_resolve_byprop(self.lib, 'type', type, 1, 1);
             if ~isempty(self.streams)
@@ -147,61 +190,88 @@ classdef lsl < handle
                 return
             end
         
-            npullmax = ceil(max(1, max(self.srate, self.sratenom)));
-            for pullCount = 1:npullmax
-                [vec, ts] = self.inlet.pull_sample(0);
-                if isempty(vec)
-                    break
+            % Pull everything available as one chunk (channels x samples)
+            [block, ts] = self.inlet.pull_chunk();
+            npulled = size(block, 2);
+            block = block';
+            if npulled == 0
+                block = zeros(0, self.lslchannels);
+            end
+            weight = ones(npulled, size(block,2));
+            if ~isempty(self.monitor)
+                [~, weight] = self.monitor.push(block);
+            end
+            if ~isempty(self.converter)
+                for k = 1:npulled
+                    block(k,:) = self.converter.push(block(k,:));
                 end
-        
-                % Stamp & count
-                self.timestamp = ts;
-                self.nsamples  = self.nsamples + 1;
-        
-                % Make sure our sample buffer was allocated
+            end
+            weight = weight(:, self.channels);
+            ts = ts(:);
+
+            % Resample to the fixed processing rate (rows due so far)
+            nrows = npulled;
+            if ~isempty(self.resampler)
+                nlsl = size(block, 2);
+                [block, ts] = self.resampler.push([block, weight], ts);
+                weight = min(max(block(:, nlsl+1:end), 0.0), 1.0);
+                block  = block(:, 1:nlsl);
+                nrows  = size(block, 1);
+            end
+
+            % Extract NF and SS channels safely (all samples at once)
+            if nrows > 0
+                % Make sure our sample buffers were allocated
                 nChans = numel(self.channels);
                 if numel(self.sample) ~= nChans
                     error('lsl:SampleBufferMismatch', ...
                           'LSL.sample length (%d) does not match channels count (%d). Did you call reset?', ...
                           numel(self.sample), nChans);
                 end
-        
-                % Extract NF channels safely
-                for idx = 1:nChans
-                    ch = self.channels(idx);
-                    if ch < 1 || ch > numel(vec)
-                        error('lsl:InvalidChannelIndex', ...
-                              'Requested NF channel index %d is out of range [1:%d].', ...
-                              ch, numel(vec));
-                    end
-                    self.sample(idx) = vec(ch);
-                end
-        
-                % Extract SS channels safely
                 nSS = numel(self.SSchannels);
                 if numel(self.SSsample) ~= nSS
                     error('lsl:SSSampleBufferMismatch', ...
                           'LSL.SSsample length (%d) does not match SSchannels count (%d).', ...
                           numel(self.SSsample), nSS);
                 end
-                for idx = 1:nSS
-                    ch = self.SSchannels(idx);
-                    if ch < 1 || ch > numel(vec)
-                        error('lsl:InvalidSSChannelIndex', ...
-                              'Requested SS channel index %d is out of range [1:%d].', ...
-                              ch, numel(vec));
-                    end
-                    self.SSsample(idx) = vec(ch);
+                bad = self.channels(self.channels < 1 | self.channels > size(block,2));
+                if ~isempty(bad)
+                    error('lsl:InvalidChannelIndex', ...
+                          'Requested NF channel index %d is out of range [1:%d].', ...
+                          bad(1), size(block,2));
                 end
-        
-                % Fire event & push marker
-                notify(self, 'NewSample');
-                if ~isempty(self.outmarker) && isvalid(self.outmarker)
-                    self.outmarker.push_sample(self.marker);
+                bad = self.SSchannels(self.SSchannels < 1 | self.SSchannels > size(block,2));
+                if ~isempty(bad)
+                    error('lsl:InvalidSSChannelIndex', ...
+                          'Requested SS channel index %d is out of range [1:%d].', ...
+                          bad(1), size(block,2));
                 end
-        
-                if pullCount == npullmax
-                    disp("WARNING: PULLED " + string(npullmax) + " LSL SAMPLES IN ONE TICK")
+            end
+            self.chunk      = block(:, self.channels);
+            self.SSchunk    = block(:, self.SSchannels);
+            self.weightchunk = weight;
+            self.timestamps = ts;
+
+            % Stamp & count (measured rate counts pulled samples)
+            if nrows > 0
+                self.sample    = self.chunk(end,:);
+                self.SSsample  = self.SSchunk(end,:);
+                self.timestamp = ts(end);
+            end
+            self.nsamples = self.nsamples + npulled;
+            if npulled > max(self.srate, self.sratenom)
+                disp("WARNING: PULLED " + string(npulled) + " LSL SAMPLES IN ONE TICK")
+            end
+
+            % Fire one event for all new rows & push markers
+            if nrows > 0
+                notify(self, 'NewChunk');
+            end
+            if npulled > 0
+                if ~isempty(self.outmarker) && isvalid(self.outmarker)
+                    for k = 1:npulled
+                        self.outmarker.push_sample(self.marker);
+                    end
                 end
             end
         
@@ -0,0 +1,121 @@
+classdef (Abstract) nfprotocol < handle
+    %NFPROTOCOL Base class of stateful (v2) protocols
+    %   A v2 protocol is a handle class in the protocols folder deriving
+    %   from this class. A fresh instance is created on every session
+    %   start, so all state lives in properties (no globals) and several
+    %   instances can run side by side.
+    %
+    %   r = requires()                       same struct as v1 protocols
+    %   init(config)                         once on start
+    %   consume(block, timestamps, markers)  only the samples since the
+    %                                        last call, block.(type) and
+    %                                        block.SS.(type) are n x ch,
+    %                                        block.artifact.(type) masks,
+    %                                        block.quality.(type) good
+    %                                        channel masks
+    %   [raw, norm] = feedback()             current feedback values
+    %   [raw, norm] = processBlock(block, timestamps, markers)
+    %                                        feedback for each of the n
+    %                                        rows (n x 1), used when
+    %                                        several samples are pending
+    %   finish(session)                      once at the end
+
+    properties
+        config       struct  = struct();    % see session.protocolconfig()
+        samplenum    double  = 0;           % samples consumed so far
+        marker       double  = 0;           % marker of last consumed sample
+        rawFeedback  double  = 0.0;         % last raw feedback
+        normFeedback double  = 0.5;         % last normalized feedback [0-1]
+        Norm         = [];                  % feedbacknorm raw -> [0,1]
+    end
+
+    methods (Abstract)
+        r = requires(self)
+        consume(self, block, timestamps, markers)
+    end
+
+    methods
+        function init(self, config)
+            self.config       = config;
+            self.samplenum    = 0;
+            self.marker       = 0;
+            self.rawFeedback  = 0.0;
+            self.normFeedback = 0.5;
+            if isfield(config, 'device') && isfield(config.device, 'normalization')
+                self.Norm = feedbacknorm(config.device.normalization);
+            else
+                self.Norm = feedbacknorm();
+            end
+        end
+
+        function [rawFeedback, normFeedback] = feedback(self)
+            rawFeedback  = self.rawFeedback;
+            normFeedback = self.normFeedback;
+        end
+
+        function [rawFeedback, normFeedback] = processBlock(self, block, timestamps, markers)
+            % Default: consume row by row. Override with a vectorized
+            % version to evaluate catch-up blocks and replays in one call.
+            n = numel(markers);
+            rawFeedback  = zeros(n, 1);
+            normFeedback = zeros(n, 1);
+            for i = 1:n
+                self.consume(nfprotocol.slice(block, i), timestamps(i), markers(i));
+                [rawFeedback(i), normFeedback(i)] = self.feedback();
+            end
+        end
+
+        function finish(~, session)
+            ploth = figure('Name', 'Session Plot');
+            ploth.NumberTitle = 'off';
+
+            nplot  = 1; % Current one
+            nplots = 3; % HbO, Feedback, Marker
+            if isfield(session.data, "HbR")
+                nplots = 4; % + HbR
+            end
+
+            % Plotting unfiltered HbO mean channel
+            if isfield(session.data, "HbO")
+                subplot(nplots,1,nplot);
+                plot(mean(session.data.HbO,2),'r');
+                title('HbO [μmol/L]');
+            end
+
+            % Plotting unfiltered HbR mean channel (optional)
+            if isfield(session.data, "HbR")
+                nplot  = nplot + 1;
+                subplot(nplots,1,nplot);
+                plot(mean(session.data.HbR,2),'b');
+                title('HbR [μmol/L]');
+            end
+
+            % Plotting Feedback values
+            nplot = nplot + 1;
+            subplot(nplots,1,nplot);
+            plot(session.normFeedback(:,1));
+            title('Feedback');
+
+            % Plotting Marker Values
+            nplot = nplot + 1;
+            subplot(nplots,1,nplot);
+            plot(session.markers(:,1));
+            title('Marker');
+        end
+    end
+
+    methods (Static)
+        function b = slice(block, r)
+            %SLICE Rows r of every (nested) field of a block
+            b = struct();
+            for fn = fieldnames(block)'
+                v = block.(fn{1});
+                if isstruct(v)
+                    b.(fn{1}) = nfprotocol.slice(v, r);
+                else
+                    b.(fn{1}) = v(r,:);
+                end
+            end
+        end
+    end
+end
@@ -0,0 +1,99 @@
+classdef profiler < handle
+    %PROFILER Timing of protocol calls during a session
+    %   Every call is stored with its marker in a preallocated ring and
+    %   counted in a histogram per marker. Bins are multiples of the
+    %   budget of the call (rows/samplerate); calls at or above it (the
+    %   bins from 1 on) are flagged.
+
+    properties (Constant)
+        SIZE        double  = 4096;         % calls kept in the ring
+        EDGES       double  = [0 0.1 0.25 0.5 0.75 1 1.5 2 4 Inf]; % x budget
+    end
+
+    properties
+        period      double  = 0.0;          % sample period (s)
+        durations   double  = zeros(0,1);   % call durations (ring, s)
+        marks       double  = zeros(0,1);   % marker per call (ring)
+        over        logical = false(0,1);   % call exceeded its budget (ring)
+        head        double  = 0;            % last written row in ring
+        count       double  = 0;            % valid rows in ring
+        calls       double  = 0;            % calls since start
+        overcount   double  = 0;            % calls over budget since start
+        markers     double  = zeros(1,0);   % markers seen so far
+        hist        double  = zeros(0,9);   % histogram per marker (row)
+    end
+
+    methods
+        function self = profiler(srate)
+            if nargin < 1, srate = 1; end
+            self.reset(srate);
+        end
+
+        function reset(self, srate)
+            self.period    = 1.0 / srate;
+            self.durations = zeros(self.SIZE, 1);
+            self.marks     = zeros(self.SIZE, 1);
+            self.over      = false(self.SIZE, 1);
+            self.head      = 0;
+            self.count     = 0;
+            self.calls     = 0;
+            self.overcount = 0;
+            self.markers   = zeros(1,0);
+            self.hist      = zeros(0, numel(self.EDGES)-1);
+        end
+
+        function record(self, span, marker, rows)
+            %RECORD One protocol call of span seconds over rows samples
+            if nargin < 4, rows = 1; end
+            budget = rows * self.period;
+            ratio  = span / budget;
+            isover = ratio >= 1;       % same rule as the bins from 1 on
+
+            self.head = mod(self.head, self.SIZE) + 1;
+            self.count = min(self.count + 1, self.SIZE);
+            self.durations(self.head) = span;
+            self.marks(self.head)     = marker;
+            self.over(self.head)      = isover;
+            self.calls     = self.calls + 1;
+            self.overcount = self.overcount + isover;
+
+            k = find(self.markers == marker, 1);
+            if isempty(k)
+                self.markers(end+1) = marker;
+                self.hist(end+1,:)  = 0;
+                k = numel(self.markers);
+            end
+            bin = discretize(ratio, self.EDGES);
+            self.hist(k,bin) = self.hist(k,bin) + 1;
+        end
+
+        function r = recentover(self)
+            %RECENTOVER Share of calls over budget in the ring
+            r = sum(self.over(1:self.count)) / max(self.count, 1);
+        end
+
+        function s = summary(self)
+            %SUMMARY One line per marker: calls, median, p95, over budget
+            s = strings(0,1);
+            for k = 1:numel(self.markers)
+                m = self.markers(k);
+                d = sort(self.durations(self.marks(1:self.count) == m));
+                if isempty(d), continue; end
+                n = numel(d);
+                s(end+1,1) = sprintf('M%02d: %d calls, med %.1f ms, p95 %.1f ms, %d over', ...
+                    m, sum(self.hist(k,:)), 1000*d(ceil(0.5*n)), ...
+                    1000*d(ceil(0.95*n)), sum(self.hist(k,find(self.EDGES == 1):end)));
+            end
+        end
+
+        function export = snapshot(self)
+            %SNAPSHOT Histograms and totals for the session file
+            export.edges     = self.EDGES;
+            export.markers   = self.markers;
+            export.hist      = self.hist;
+            export.calls     = self.calls;
+            export.overcount = self.overcount;
+            export.period    = self.period;
+        end
+    end
+end
@@ -9,6 +9,7 @@ classdef protocols < handle
         list     struct = []
         selected struct = struct([]);
         SSselected struct = struct([]);
+        active   = [];                  % running v2 instance ([] for v1)
     end
     
     methods
@@ -83,6 +84,19 @@ classdef protocols < handle
                     return
                 end
             end
+            % check derived types (spatial filters of the device)
+            if isfield(req, 'derived')
+                names = strings(0);
+                if isfield(dev, 'spatial') && ~isempty(dev.spatial)
+                    names = string({dev.spatial.name});
+                end
+                for idx = 1:length(req.derived)
+                    if ~any(names == string(req.derived(idx).type))
+                        r = false;
+                        return
+                    end
+                end
+            end
             r = true;
             % check SSchannel requirements
             if ~isfield(req, 'SSchannels')
@@ -104,6 +118,29 @@ classdef protocols < handle
             end
         end
         
+        function start(self, config)
+            %START Initialize the selected protocol for a new session
+            %   v2 protocols (nfprotocol) get a fresh instance, so no state
+            %   leaks from one run into the next.
+            fh = self.selected.fh;
+            if isa(fh, 'nfprotocol')
+                self.active = feval(class(fh));
+                self.active.init(config);
+            else
+                self.active = [];
+                fh.init();
+            end
+        end
+
+        function f = finisher(self)
+            %FINISHER Handle called with the session snapshot at the end
+            if ~isempty(self.active)
+                f = @self.active.finish;
+            else
+                f = self.selected.fh.finish;
+            end
+        end
+
         function r = select(self, name)
             for p = 1:length(self.list)
                 % exact match
@@ -0,0 +1,77 @@
+function [rawFeedback, normFeedback, span] = replay_session(matPath, protocol, blocksize)
+%REPLAY_SESSION Re-run a v2 protocol offline on a saved session.
+%
+% [raw, norm, span] = replay_session(matPath, protocol, blocksize)
+%
+% Inputs:
+%   matPath   : saved session (.mat, full or compact storage)
+%   protocol  : class name of a v2 protocol (e.g. "MovAvg")
+%   blocksize : rows per processBlock call (default: all at once)
+%
+% Outputs:
+%   rawFeedback, normFeedback : one value per recorded sample (n x 1)
+%   span                      : seconds spent in processBlock
+%
+% Notes:
+% - The protocol gets the same config as in the live session, built
+%   from the saved sample rate, window size, channels and device.
+% - Use a blocksize of 1 to reproduce the live per-sample evaluation.
+
+    if nargin < 3, blocksize = Inf; end
+
+    s = decode_session(load(matPath));
+    p = feval(protocol);
+    if ~isa(p, 'nfprotocol')
+        error('replay_session:NotV2', '%s is not a v2 (nfprotocol) protocol', protocol);
+    end
+
+    % same config as session.protocolconfig()
+    n = numel(s.markers);
+    config.srate      = s.samplerate;
+    config.windowsize = double(s.windowsize);
+    config.datasize   = n;
+    config.channels   = s.channels;
+    config.SSchannels = s.SSchannels;
+    config.counts     = struct();
+    config.SScounts   = struct();
+    config.device     = s.device;
+    config.markerinfo = [];
+    if isfield(s, 'markerinfo')
+        config.markerinfo = s.markerinfo;
+    end
+    block = struct('SS', struct());
+    for fn = fieldnames(s.data)'
+        block.(fn{1}) = s.data.(fn{1});
+        config.counts.(fn{1}) = size(s.data.(fn{1}), 2);
+    end
+    % protocols saw the corrected/weighted samples, not data as acquired
+    if isfield(s, 'processed')
+        for fn = fieldnames(s.processed)'
+            block.(fn{1}) = s.processed.(fn{1});
+        end
+    end
+    for f = ["artifact", "quality"]
+        if isfield(s, f)
+            block.(f) = s.(f);
+        end
+    end
+    if isfield(s, 'SSdata')
+        for fn = fieldnames(s.SSdata)'
+            block.SS.(fn{1}) = s.SSdata.(fn{1});
+            config.SScounts.(fn{1}) = size(s.SSdata.(fn{1}), 2);
+        end
+    end
+    p.init(config);
+
+    % feed the recording in blocks
+    rawFeedback  = zeros(n, 1);
+    normFeedback = zeros(n, 1);
+    tick = tic();
+    for first = 1:min(blocksize, n):n
+        r = first:min(first + blocksize - 1, n);
+        [rawFeedback(r), normFeedback(r)] = p.processBlock( ...
+            nfprotocol.slice(block, r), s.times(r), s.markers(r));
+    end
+    span = toc(tick);
+    normFeedback = min(max(normFeedback, 0.0), 1.0);
+end
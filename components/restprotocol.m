@@ -0,0 +1,158 @@
+classdef (Abstract) restprotocol < nfprotocol
+    %RESTPROTOCOL Rest (marker 2) vs. task (marker 3) HbO feedback
+    %   Scheme shared by the NIRS example protocols:
+    %   - every new HbO sample goes through transform() (filtering,
+    %     regression, window bookkeeping of the concrete protocol), or
+    %     a whole block through transformBlock() if it is vectorized
+    %   - during rest the transformed samples go into a restbaseline,
+    %     which tracks amplitude and rest average while they arrive;
+    %     5 frames before 30 s baseline() takes over its values
+    %   - during task the feedback is the window mean minus the rest
+    %     average in units of the rest amplitude, mapped to [0,1] by the
+    %     adaptive normalization (Norm, see feedbacknorm)
+
+    properties
+        rest        restbaseline;           % resting phase buffer/estimators
+        restValue   double  = 0.0;          % rest average
+        correction  double  = 1.0;          % 1 / rest amplitude
+        windowValue double  = 0.0;          % last task window mean
+    end
+
+    methods (Abstract, Access = protected)
+        y = transform(self, x, ss)          % consume one HbO row
+        m = windowmean(self)                % current task window mean
+    end
+
+    methods
+        function r = requires(~)
+            r.devicetype = "NIRS";
+            % required window min and max durations
+            r.window.mins = 1.0;
+            r.window.maxs = 10.0;
+            % requires at least one HbO channel
+            r.channels(1).type = "HbO";
+            r.channels(1).unit = "μmol/L";
+            r.channels(1).min = 1;
+            r.channels(1).max = 64;
+            % HbR is optional
+            r.channels(2).type = "HbR";
+            r.channels(2).unit = "μmol/L";
+            r.channels(2).min = 0;
+            r.channels(2).max = 64;
+        end
+
+        function init(self, config)
+            init@nfprotocol(self, config);
+            nss = 0;
+            if isfield(config.SScounts, 'HbO')
+                nss = config.SScounts.HbO;
+            end
+            self.rest = restbaseline(config.srate, config.counts.HbO, nss);
+            self.restValue  = 0.0;
+            self.correction = 1.0;
+        end
+
+        function consume(self, block, timestamps, markers)
+            self.processBlock(block, timestamps, markers);
+        end
+
+        function [rawFeedback, normFeedback] = processBlock(self, block, ~, markers)
+            % IMPORTANT:
+            %   Your algorithm must take less than (1/samplerate) seconds
+            %   in average or else you fall behind schedule and get a drift.
+            %   If it does not, the scheduler runs it on every n-th window
+            %   only (see scheduler.m) and this block grows accordingly.
+            %   Timings are collected by the session's profiler.
+            hbo = block.HbO;
+            n   = size(hbo,1);
+            SShbo = zeros(n, 0);
+            if isfield(block.SS, 'HbO')
+                SShbo = block.SS.HbO;
+            end
+
+            % heavy part (filtering, window means) on the whole block
+            [y, wm] = self.transformBlock(hbo, SShbo, markers == 3);
+
+            % cheap per-row rest/task bookkeeping
+            rawFeedback  = zeros(n, 1);
+            normFeedback = zeros(n, 1);
+            for i = 1:n
+                self.step(y(i,:), SShbo(i,:), wm(i), markers(i));
+                rawFeedback(i)  = self.rawFeedback;
+                normFeedback(i) = self.normFeedback;
+            end
+        end
+    end
+
+    methods (Access = protected)
+        function [y, wm] = transformBlock(self, x, ss, need)
+            %TRANSFORMBLOCK Transform rows of x, window mean after each row
+            %   Only rows with need(i) require wm(i). Default loops over
+            %   transform(); override with a vectorized version.
+            y  = zeros(size(x));
+            wm = nan(size(x,1), 1);
+            for i = 1:size(x,1)
+                y(i,:) = self.transform(x(i,:), ss(i,:));
+                if need(i)
+                    wm(i) = self.windowmean();
+                end
+            end
+        end
+
+        function step(self, y, ss, wm, marker)
+            %STEP Rest/task bookkeeping for one transformed row
+            self.samplenum = self.samplenum + 1;
+            rawFeedback  = 0.0;
+            normFeedback = 0.5;
+
+            if marker == 2
+                %% RESTING PHASE
+
+                % reset on switch
+                if self.marker ~= 2
+                    self.restreset();
+                end
+
+                % saving the values of the last sample
+                self.restsample(y, ss);
+
+                % 5 frames before 30 seconds of rest (to avoid final delays)
+                if self.rest.due()
+                    self.baseline();
+                end
+
+            elseif marker == 3
+                %% CONCENTRATION PHASE
+                self.windowValue = wm;
+
+                % feedback is difference in HbO scaled by correction
+                rawFeedback = (self.windowValue - self.restValue) * self.correction;
+
+                % map to [0,1] by the percentiles of the raw feedback
+                normFeedback = self.Norm.push(rawFeedback, marker);
+            end
+
+            self.marker       = marker;
+            self.rawFeedback  = rawFeedback;
+            self.normFeedback = normFeedback;
+        end
+
+        function restreset(self)
+            self.rest.reset();
+        end
+
+        function restsample(self, y, ss)
+            self.rest.push(y, ss);
+        end
+
+        function baseline(self)
+            %% CORRECTION FACTOR USING AMPLITUDE
+            % distance of high and low quantile of the average HbO
+            % channel over the last ~15s of rest (tracked while resting)
+            self.correction = 1.0 / self.rest.amplitude();
+
+            %% AVERAGE OF HBO OF LAST ~5S OF RESTING PHASE
+            self.restValue = self.rest.restmean();
+        end
+    end
+end
@@ -0,0 +1,45 @@
+function [W, names] = roiweights(config, type)
+%ROIWEIGHTS Averaging matrix from the selected channels of a type to ROIs.
+%
+% [W, names] = roiweights(config, type)
+%
+% Inputs:
+%   config : protocol config (see session.protocolconfig)
+%   type   : channel type of the columns (default "HbO")
+%
+% Outputs:
+%   W      : columns x ROIs, block.(type) * W gives the ROI means
+%   names  : ROI names (1 x ROIs)
+%
+% Notes:
+% - ROIs are groups of devch numbers in config.device.channel_map.rois.
+% - ROIs without a selected channel of the type are skipped with a
+%   warning; W has no columns if no ROI is configured.
+
+    if nargin < 2, type = "HbO"; end
+
+    lslch = config.device.lsl.channels;
+    devch = zeros(1, 0);
+    for ch = config.channels(:)'
+        if ch <= numel(lslch) && string(lslch(ch).type) == type
+            devch(end+1) = lslch(ch).devch; %#ok<AGROW>
+        end
+    end
+
+    rois = struct();
+    cm = config.device.channel_map;
+    if isstruct(cm) && isfield(cm, 'rois') && isstruct(cm.rois)
+        rois = cm.rois;
+    end
+    W = zeros(numel(devch), 0);
+    names = strings(1, 0);
+    for f = fieldnames(rois)'
+        member = ismember(devch, rois.(f{1}));
+        if ~any(member)
+            warning("roiweights: ROI %s has no selected %s channel", f{1}, type);
+            continue;
+        end
+        W(:,end+1) = member(:) / nnz(member); %#ok<AGROW>
+        names(end+1) = string(f{1}); %#ok<AGROW>
+    end
+end
@@ -0,0 +1,71 @@
+classdef scheduler < handle
+    %SCHEDULER Decides on which windows the protocol is evaluated
+    %   Keeps an exponential moving average of the protocol cost per call
+    %   and picks the smallest stride (evaluate every n-th window) that
+    %   keeps it within a budget of BUDGET * stride / samplerate. In
+    %   between, the previous feedback is held. The stride in use is
+    %   logged at every epoch change.
+
+    properties (Constant)
+        BUDGET      double  = 0.5;          % usable share of a sample period
+        ALPHA       double  = 0.1;          % EMA weight of a new measurement
+        MAXSTRIDE   double  = 50;           % never skip more windows than this
+    end
+
+    properties
+        period      double  = 0.0;          % sample period (s)
+        cost        double  = 0.0;          % EMA of protocol cost per call (s)
+        stride      double  = 1;            % evaluate every stride-th window
+        pending     double  = 0;            % rows since last evaluation
+        rawHold     double  = 0.0;          % held raw feedback
+        normHold    double  = 0.5;          % held normalized feedback
+        log         double  = zeros(0,3);   % [time marker stride] per epoch
+    end
+
+    methods
+        function self = scheduler(srate)
+            if nargin < 1, srate = 1; end
+            self.reset(srate);
+        end
+
+        function reset(self, srate)
+            self.period   = 1.0 / srate;
+            self.cost     = 0.0;
+            self.stride   = 1;
+            self.pending  = 0;
+            self.rawHold  = 0.0;
+            self.normHold = 0.5;
+            self.log      = zeros(0,3);
+        end
+
+        function r = due(self, n)
+            %DUE True if the protocol should run on this window (n new rows)
+            if nargin < 2, n = 1; end
+            self.pending = self.pending + n;
+            r = self.pending >= self.stride;
+        end
+
+        function record(self, span, rawFb, normFb)
+            %RECORD Cost and result of an evaluation, adapt the stride
+            self.pending  = 0;
+            self.rawHold  = rawFb;
+            self.normHold = normFb;
+            if self.cost == 0
+                self.cost = span;
+            else
+                self.cost = (1-self.ALPHA)*self.cost + self.ALPHA*span;
+            end
+            budget = self.BUDGET * self.period;
+            self.stride = min(max(ceil(self.cost / budget), 1), self.MAXSTRIDE);
+        end
+
+        function epoch(self, time, marker)
+            %EPOCH Log the stride in use when an epoch starts
+            self.log(end+1,:) = [time marker self.stride];
+            if self.stride > 1
+                disp("SCHEDULER: EVALUATING EVERY " + string(self.stride) + ...
+                    " WINDOWS (COST " + sprintf('%.3f', self.cost) + "s)");
+            end
+        end
+    end
+end
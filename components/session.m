@@ -12,17 +12,27 @@ classdef session < handle
         protocolmax double  = 0.0;          % max tracked protocol exec time
         protocolavg double  = 0.0;          % avg tracked protocol exec time
         protocolsum double  = 0.0;          % sum tracked protocol exec time
+        schedule    scheduler;              % protocol evaluation stride
+        profile     profiler;               % protocol call timings
         srate       double  = 0.0;          % sample rate
         device      struct  = struct();     % device used in session
         channels    uint32  = [];           % channel numbers (NF)
         SSchannels  uint32  = [];           % channel numbers (SS)
         fn          cell    = {};           % field names in data and window
-        data        struct  = struct();     % session data (NF)
+        data        struct  = struct();     % session data (NF, as acquired)
+        processed   struct  = struct();     % NF data fed to protocols (corrected/weighted)
+        artifact    struct  = struct();     % artifact mask per type (NF)
+        cleaner     = [];                   % artifactfilter ([] = disabled)
+        quality     struct  = struct();     % good-channel mask per type (NF)
+        qualityaction string = "none";      % bad channels: "none" | "drop" | "weight"
+        spatial     struct  = struct();     % spatialfilter per derived type
+        spatialcols struct  = struct();     % source columns per derived type
         SSdata      struct  = struct();     % session data (SS)
         datasize    uint32  = 0;            % rows count in data
         times       double  = zeros(0,1);   % timestamps of session data
         idx         uint32  = 0;            % current index in data and times
-        firsttime   double  = 0.0;          % first timestamp
+        fbidx       uint32  = 0;            % last index with feedback
+        firsttime   double  = 0.0;          % first timestamp (stream time origin)
         window      struct  = struct();     % current window (NF)
         SSwindow    struct  = struct();     % current window (SS)
         windowsize  uint32  = 0;            % rows count in window
@@ -32,6 +42,10 @@ classdef session < handle
         normFeedback double  = zeros(0,1);   % recorded *normalized* feedback [0–1]
         rawFeedback  double  = zeros(0,1);   % recorded *raw* feedback (e.g. HbO difference)
         markerinfo  double  = zeros(0,8);   % info about epochs
+        epochbounds double  = zeros(0,1);   % sorted epoch boundaries (s)
+        epochrows   uint32  = zeros(0,1);   % markerinfo row per interval (0 = none)
+        epochcursor uint32  = 0;            % current interval in epochbounds
+        epochnext   double  = Inf;          % time of next epoch transition (s)
         markers     double  = zeros(0,1);   % recorded epochs
         marker      double  = 0.0;          % current epoch (0 = undefined)
         bgcolor     double  = [0 0 0];      % current epoch background color
@@ -39,6 +53,7 @@ classdef session < handle
         study       string  = "";           % name of study
         subject     uint32  = 1;            % subject number
         run         uint32  = 1;            % run number
+        storage     string  = "full";       % file profile: "full" | "compact"
         transfer    logical  = false; % per‐epoch: whether transfer 1 or neurofeedback 0
         runType     categorical;      % per-sample vector, "transfer" | "neurofeedback"
         nf_channels_used uint32 = uint32([]); % Neurofeedback channels used as inputs to the algorithm
@@ -85,6 +100,17 @@ classdef session < handle
             end
         end
         
+        %% Return type of each selected NF channel
+        function types = channelTypes(self)
+            lslchannels = self.device.lsl.channels;
+            types = repmat("unknown", 1, numel(self.channels));
+            for i = 1:numel(self.channels)
+                if self.channels(i) <= numel(lslchannels)
+                    types(i) = string(lslchannels(self.channels(i)).type);
+                end
+            end
+        end
+
         %% Return SS Channel Counts for each Type
         function r = countSSChannelTypes(self)
             r = struct();
@@ -109,6 +135,11 @@ classdef session < handle
                 r = false;
                 return;
             end
+            % resampled streams arrive at the device's fixed rate
+            % (see lsl.processingrate), whatever rate the caller passed
+            if isfield(device, 'resample') && device.resample.enabled
+                srate = device.resample.rate;
+            end
             self.datasize   = ceil(srate * lengthmax);
             self.windowsize = ceil(srate * window);
             self.running    = true;
@@ -126,11 +157,29 @@ classdef session < handle
             self.protocolmax = 0.0;
             self.protocolavg = 0.0;
             self.protocolsum = 0.0;
+            self.schedule    = scheduler(srate);
+            self.profile     = profiler(srate);
             self.lengthmax   = lengthmax;
             self.srate       = srate;
             self.device      = device;
+            if isfield(device, 'storage')
+                self.storage = device.storage;
+            end
             self.channels    = channels;
             self.SSchannels  = SSchannels;
+            if isfield(device, 'threads')
+                channelpool.shared().configure(device.threads.count, ...
+                    device.threads.threshold);
+            end
+            self.cleaner     = [];
+            if isfield(device, 'artifacts') && device.artifacts.enabled
+                self.cleaner = artifactfilter(numel(channels), srate, ...
+                    device.artifacts.threshold, device.artifacts.tau);
+            end
+            self.qualityaction = "none";
+            if isfield(device, 'quality') && device.quality.enabled
+                self.qualityaction = device.quality.action;
+            end
             % initialize everything as “transfer”
             self.transfer = false;
             self.runType    = categorical( ...
@@ -138,16 +187,43 @@ classdef session < handle
                                 ["neurofeedback","transfer"]);
             counts   = self.countChannelTypes();
             SScounts = self.countSSChannelTypes();
+
+            % Derived types from spatial filters on a selected type
+            self.spatial     = struct();
+            self.spatialcols = struct();
+            if isfield(device, 'spatial')
+                types = self.channelTypes();
+                for s = device.spatial(:)'
+                    src = string(s.source);
+                    if ~isfield(counts, src), continue; end
+                    name = char(s.name);
+                    self.spatialcols.(name) = find(types == src);
+                    self.spatial.(name) = spatialfilter(s.method, ...
+                        counts.(src), srate, s.components);
+                    counts.(name) = counts.(src);
+                end
+            end
             
             % Initialize data structures for NF
-            self.data   = struct();
-            self.window = struct();
+            % (processed only if correction or weighting changes samples)
+            self.data     = struct();
+            self.processed = struct();
+            self.artifact = struct();
+            self.quality  = struct();
+            self.window   = struct();
             fnTypes = fieldnames(counts);
             for k = 1:numel(fnTypes)
                 t = fnTypes{k};
-                self.data.(t)   = zeros(self.datasize, counts.(t));
+                self.data.(t)     = zeros(self.datasize, counts.(t));
+                self.artifact.(t) = false(self.datasize, counts.(t));
+                self.quality.(t)  = true(self.datasize, counts.(t));
                 self.window.(t) = zeros(self.windowsize, counts.(t));
             end
+            if ~isempty(self.cleaner) || self.qualityaction ~= "none"
+                for fn = fieldnames(self.countChannelTypes())'
+                    self.processed.(fn{1}) = zeros(size(self.data.(fn{1})));
+                end
+            end
             
             % Initialize data structures for SS
             self.SSdata   = struct();
@@ -165,9 +241,12 @@ classdef session < handle
             self.rawFeedback  = zeros(self.datasize, 1);
             self.markers     = zeros(self.datasize, 1);
             self.markerinfo  = markerinfo;
+            self.compileEpochs();
             self.windowtimes = zeros(self.windowsize, 1);
             
             self.idx        = 0;
+            self.fbidx      = 0;
+            self.firsttime  = 0.0;
             self.windowidx  = 0;
             self.windownum  = 1;
             self.marker     = 0.0;
@@ -194,7 +273,6 @@ classdef session < handle
             self.stoptime = now();
             r = true;
             notify(self, 'Stopped');
-            self.save();
         end
         
         %% Periodic update (epoch, length, stop conditions)
@@ -204,24 +282,33 @@ classdef session < handle
             % Update session length
             self.length = toc(self.starttick);
             
-            % Update epoch
+            % Update epoch (advance cursor over passed boundaries)
             oldMarker = self.marker;
-            foundEpoch = false;
-            for i = 1:size(self.markerinfo,1)
-                m = self.markerinfo(i,:);
-                if self.length >= m(1) && self.length <= m(2)
-                    self.marker  = m(3);
+            oldCursor = self.epochcursor;
+            nbounds   = numel(self.epochbounds);
+            while self.epochcursor < nbounds && ...
+                  self.length >= self.epochbounds(self.epochcursor+1)
+                self.epochcursor = self.epochcursor + 1;
+            end
+            if self.epochcursor ~= oldCursor
+                if self.epochcursor < nbounds
+                    self.epochnext = self.epochbounds(self.epochcursor+1);
+                else
+                    self.epochnext = Inf;
+                end
+                row = self.epochrows(self.epochcursor);
+                if row > 0
+                    m = self.markerinfo(row,:);
+                    self.marker    = m(3);
                     self.transfer  = logical(m(4));
                     self.fbvisible = logical(m(5));
                     self.bgcolor   = m(6:8);
-                    foundEpoch = true;
-                    break;
+                else
+                    self.marker = 0.0;
                 end
             end
-            if ~foundEpoch
-                self.marker = 0.0;
-            end
             if self.marker ~= oldMarker
+                self.schedule.epoch(self.length, self.marker);
                 notify(self, 'Epoch');
             end
             
@@ -231,18 +318,150 @@ classdef session < handle
             end
         end
         
+        %% Compile markerinfo into sorted boundaries with one row per interval
+        function compileEpochs(self)
+            % Interval k spans [epochbounds(k), epochbounds(k+1)) and is
+            % assigned the first markerinfo row covering it (earlier rows
+            % win on overlap). Bounds are seconds since the first sample
+            % in stream time (LSL timestamps), see label(); update() walks
+            % them by wall clock for the display and triggers only.
+            self.epochcursor = 0;
+            self.epochnext   = Inf;
+            if isempty(self.markerinfo)
+                self.epochbounds = zeros(0,1);
+                self.epochrows   = zeros(0,1,'uint32');
+                return;
+            end
+            starts = self.markerinfo(:,1);
+            stops  = self.markerinfo(:,2);
+            self.epochbounds = unique([starts; stops]);
+            nbounds = numel(self.epochbounds);
+            self.epochrows = zeros(nbounds, 1, 'uint32');
+            for k = 1:nbounds
+                t = self.epochbounds(k);
+                row = find(starts <= t & stops > t, 1, 'first');
+                if ~isempty(row)
+                    self.epochrows(k) = row;
+                end
+            end
+            self.epochnext = self.epochbounds(1);
+        end
+
+        %% Epoch marker and transfer flag per relative stream time
+        function [mk, tr] = label(self, relts)
+            % Interval lookup of all times at once, samples before the
+            % first or between epochs get marker 0 (no transfer).
+            n  = numel(relts);
+            mk = zeros(n, 1);
+            tr = false(n, 1);
+            if isempty(self.epochbounds), return; end
+            k = discretize(relts(:), [self.epochbounds; Inf]);
+            rows = zeros(n, 1);
+            rows(~isnan(k)) = self.epochrows(k(~isnan(k)));
+            has = rows > 0;
+            mk(has) = self.markerinfo(rows(has), 3);
+            tr(has) = logical(self.markerinfo(rows(has), 4));
+        end
+
+        %% Label stored rows first..last from their timestamps
+        function labelrows(self, first, last)
+            r = first:last;
+            [mk, tr] = self.label(self.times(r));
+            self.markers(r) = mk;
+            self.runType(r(tr))  = "transfer";
+            self.runType(r(~tr)) = "neurofeedback";
+        end
+
         %% Push a new sample to running session
-        function pushSample(self, sample, SSsample, ts)
+        function pushSample(self, sample, SSsample, ts, weight)
             if ~self.running, return; end
-            
-            % Increment index
-            self.idx = self.idx + 1;
+            if nargin < 5, weight = ones(size(sample)); end
+            raw = sample;
+            [sample, bad] = self.clean(sample);
+            sample = self.weigh(sample, weight);
+            D = self.derive(sample);
+            self.append(raw, sample, SSsample, ts, bad, weight >= 1, D, 1);
+            self.labelrows(self.idx, self.idx);
 
-            if self.transfer
-                self.runType(self.idx) = "transfer";
+            % Notify window event
+            notify(self, 'Window');
+            if self.windowidx >= self.windowsize
+                self.windownum = self.windownum + 1;
+            end
+        end
+
+        %% Push a block of samples (rows) with a single window event
+        function pushBlock(self, samples, SSsamples, ts, weights)
+            % Used when several samples arrive in one tick (catch-up),
+            % the Window listener then evaluates all pending rows at once.
+            if ~self.running, return; end
+            if nargin < 5, weights = ones(size(samples)); end
+            n = min(size(samples,1), double(self.datasize - self.idx));
+            if n <= 0, return; end
+            raw = samples(1:n,:);
+            [samples, bad] = self.clean(raw);
+            samples = self.weigh(samples, weights(1:n,:));
+            good = weights(1:n,:) >= 1;
+            D = self.derive(samples);
+            first = self.idx + 1;
+            for i = 1:n
+                self.append(raw(i,:), samples(i,:), SSsamples(i,:), ts(i), ...
+                    bad(i,:), good(i,:), D, i);
+                if self.windowidx >= self.windowsize
+                    self.windownum = self.windownum + 1;
+                end
+            end
+            self.labelrows(first, self.idx);
+            notify(self, 'Window');
+        end
+
+        %% Motion artifact correction of new NF rows (for protocols)
+        function [samples, bad] = clean(self, samples)
+            if isempty(self.cleaner)
+                bad = false(size(samples));
             else
-                self.runType(self.idx) = "neurofeedback";
+                [samples, bad] = self.cleaner.push(samples);
+            end
+        end
+
+        %% Drop or down-weight channels of poor quality (weights 0-1)
+        function samples = weigh(self, samples, W)
+            % Bad channels are moved towards the weighted mean of their
+            % type in the same row, so channel averages follow the good
+            % channels and the column layout stays unchanged.
+            if self.qualityaction == "none", return; end
+            if self.qualityaction == "drop"
+                W = double(W >= 1);
             end
+            types = self.channelTypes();
+            for t = unique(types)
+                cols = types == t;
+                w    = W(:,cols);
+                x    = samples(:,cols);
+                tot  = sum(w, 2);
+                ref  = sum(w .* x, 2) ./ max(tot, eps);
+                y    = w .* x + (1 - w) .* ref;
+                keep = tot == 0;
+                y(keep,:) = x(keep,:);
+                samples(:,cols) = y;
+            end
+        end
+
+        %% Derived rows of new NF rows (spatial filters per block)
+        function D = derive(self, samples)
+            D = struct();
+            for fn = fieldnames(self.spatial)'
+                cols = self.spatialcols.(fn{1});
+                D.(fn{1}) = self.spatial.(fn{1}).push(samples(:,cols));
+            end
+        end
+
+        %% Append one sample to data and window
+        function append(self, raw, sample, SSsample, ts, bad, good, D, row)
+            % raw is stored in data, the corrected/weighted sample in
+            % processed (if allocated) and the window protocols read.
+            % Increment index
+            self.idx = self.idx + 1;
 
             if self.firsttime == 0
                 self.firsttime = ts;
@@ -266,10 +485,9 @@ classdef session < handle
                 self.windowtimes = circshift(self.windowtimes, -1);
             end
             
-            % Store times and markers
+            % Store times (markers are labelled from them, see labelrows)
             self.windowtimes(self.windowidx) = relts;
             self.times(self.idx)             = relts;
-            self.markers(self.idx)           = self.marker;
             
             % Prepare column counters
             colidx   = struct();
@@ -290,10 +508,22 @@ classdef session < handle
                     colidx.(type) = 1;
                 end
                 idxCol = colidx.(type);
-                self.data.(type)(self.idx, idxCol)   = val;
+                self.data.(type)(self.idx, idxCol)   = raw(i);
+                if isfield(self.processed, type)
+                    self.processed.(type)(self.idx, idxCol) = val;
+                end
+                self.artifact.(type)(self.idx, idxCol) = bad(i);
+                self.quality.(type)(self.idx, idxCol)  = good(i);
                 self.window.(type)(self.windowidx, idxCol) = val;
                 colidx.(type) = idxCol + 1;
             end
+
+            % --- Derived (spatially filtered) types
+            for fn = fieldnames(D)'
+                t = fn{1};
+                self.data.(t)(self.idx,:) = D.(t)(row,:);
+                self.window.(t)(self.windowidx,:) = D.(t)(row,:);
+            end
             
             % --- Process SS sample values (guard against empty)
             if ~isempty(self.SSchannels) && ~isempty(SSsample)
@@ -315,29 +545,78 @@ classdef session < handle
                     SScolidx.(type) = idxCol + 1;
                 end
             end
-            
-            % Notify window event
-            notify(self, 'Window');
-            if self.windowidx >= self.windowsize
-                self.windownum = self.windownum + 1;
-            end
         end
         
-        %% Push a new feedback to running session
+        %% Configuration handed to v2 protocols on start
+        function config = protocolconfig(self)
+            config.srate      = self.srate;
+            config.windowsize = double(self.windowsize);
+            config.datasize   = double(self.datasize);
+            config.channels   = self.channels;
+            config.SSchannels = self.SSchannels;
+            config.counts     = self.countChannelTypes();
+            for fn = fieldnames(self.spatial)'
+                config.counts.(fn{1}) = size(self.data.(fn{1}), 2);
+            end
+            config.SScounts   = self.countSSChannelTypes();
+            config.device     = self.device;
+            config.markerinfo = self.markerinfo;
+        end
+
+        %% NF data as protocols see it (processed over acquired types)
+        function d = protocoldata(self)
+            d = self.data;
+            for fn = fieldnames(self.processed)'
+                d.(fn{1}) = self.processed.(fn{1});
+            end
+        end
+
+        %% Recorded rows first..last as block for v2 protocols
+        function [block, times, markers] = rows(self, first, last)
+            r = first:last;
+            block = struct();
+            d = self.protocoldata();
+            for fn = fieldnames(d)'
+                block.(fn{1}) = d.(fn{1})(r,:);
+            end
+            block.artifact = struct();
+            for fn = fieldnames(self.artifact)'
+                block.artifact.(fn{1}) = self.artifact.(fn{1})(r,:);
+            end
+            block.quality = struct();
+            for fn = fieldnames(self.quality)'
+                block.quality.(fn{1}) = self.quality.(fn{1})(r,:);
+            end
+            block.SS = struct();
+            for fn = fieldnames(self.SSdata)'
+                block.SS.(fn{1}) = self.SSdata.(fn{1})(r,:);
+            end
+            times   = self.times(r);
+            markers = self.markers(r);
+        end
+
+        %% Push new feedback (one value per newest row) to running session
         function pushFeedback(self, rawVal, normVal, span)
             if ~self.running, return; end
+            rows = self.idx-numel(rawVal)+1:self.idx;
             % store the un‑scaled (raw) feedback
-            self.rawFeedback(self.idx)  = rawVal;
+            self.rawFeedback(rows)  = rawVal;
             % store the scaled [0–1] feedback
-            self.normFeedback(self.idx) = normVal;
+            self.normFeedback(rows) = normVal;
+            self.fbidx = self.idx;
             % protocol timing book‑keeping remains the same
             self.protocolsum  = self.protocolsum + span;
             self.protocolavg  = self.protocolsum / double(self.idx);
             self.protocolmax  = max(self.protocolmax, span);
         end
         
-        %% Save session to disk
+        %% Save session to disk (blocking, see finalizer for async)
         function save(self)
+            write_session(self.snapshot(), self.filepath(".mat"));
+        end
+
+        %% Copy of all recorded data, independent of the session buffers
+        function export = snapshot(self)
             % how many samples actually recorded
             used = max(self.idx, 1);
 
@@ -357,6 +636,10 @@ classdef session < handle
 
             export.device     = self.device;
             export.protocol   = self.protocol;
+            export.storage    = self.storage;
+            export.markerinfo = self.markerinfo;
+            export.schedule   = self.schedule.log; % [time marker stride]
+            export.profile    = self.profile.snapshot();
             
             % per-sample bookkeeping
             export.times       = self.times(1:used);
@@ -382,8 +665,14 @@ classdef session < handle
             for k = 1:numel(types)
                 t = types{k};
                 export.data.(t) = self.data.(t)(1:used, :);
+                export.artifact.(t) = self.artifact.(t)(1:used, :);
+                export.quality.(t)  = self.quality.(t)(1:used, :);
                 export.window.(t) = self.window.(t)(1:min(self.windowidx,self.windowsize), :);
             end
+            for fn = fieldnames(self.processed)'
+                t = fn{1};
+                export.processed.(t) = self.processed.(t)(1:used, :);
+            end
             
             % Export SS data
             typesSS = fieldnames(self.SSdata);
@@ -394,8 +683,10 @@ classdef session < handle
             end
             
             export.windowtimes = self.windowtimes(1:min(self.windowidx,self.windowsize));
-            
-            
+        end
+
+        %% Collision-free output path <Study>_S###_R##_<ts>[_vNN]<ext>
+        function fpath = filepath(self, ext)
             % Study folder & safe names
             studyName = self.study;
             if studyName == "", studyName = "unnamed"; end
@@ -410,15 +701,15 @@ classdef session < handle
             ts = string(datetime(self.starttime, 'ConvertFrom', 'datenum', ...
                                  'Format', 'yyyy-MM-dd_HH-mm-ss'));
         
-            % Filename: <Study>_S###_R##_<ts>.mat
+            % Filename: <Study>_S###_R##_<ts><ext>
             baseName = sprintf("%s_S%03d_R%02d_%s", safeStudy, self.subject, self.run, ts);
-            fpath    = fullfile(baseDir, baseName + ".mat");
+            fpath    = fullfile(baseDir, baseName + ext);
         
             % A rare collision handling: add _v02, _v03, ...
             if exist(fpath, 'file')
                 k = 2;
                 while true
-                    candidate = fullfile(baseDir, baseName + sprintf("_v%02d.mat", k));
+                    candidate = fullfile(baseDir, baseName + sprintf("_v%02d", k) + ext);
                     if ~exist(candidate, 'file')
                         fpath = candidate;
                         break;
@@ -426,9 +717,6 @@ classdef session < handle
                     k = k + 1;
                 end
             end
-        
-            % Save
-            save(fpath, '-struct', 'export');
         end
     end
 end
@@ -0,0 +1,191 @@
+classdef stagechain < handle
+    %STAGECHAIN Preprocessing chain compiled from a JSON stage list
+    %   The device JSON declares the chain as "pipeline", a list of
+    %   stages either as arrays or objects:
+    %
+    %       ["bandpass", 0.01, 0.5]
+    %       {"stage": "bandpass", "low": 0.01, "high": 0.5, "order": 3}
+    %
+    %   On start the list is compiled once into streaming DSP objects
+    %   and one function handle per stage; push() then runs each new
+    %   block through all stages in one pass (all channels at once).
+    %
+    %   Stages (parameters in order, seconds and Hz):
+    %     mbll                    raw wavelengths to HbO/HbR, requires
+    %                             device.mbll, which converts upstream
+    %     bandpass  low high order  Butterworth bandpass (sosfilter)
+    %     lowpass   cutoff order    Butterworth lowpass
+    %     highpass  cutoff order    Butterworth highpass
+    %     gauss     cutoff order    Gaussian FIR smoothing
+    %     detrend   window          sliding linear detrending
+    %     ss_regress window         sliding mean short channel regression
+    %     roi_mean                  mean per channel_map.rois group (or
+    %                               over all channels without ROIs)
+
+    properties (Constant)
+        PARAMS = struct( ...                % parameter names per stage
+            'mbll',       {{}}, ...
+            'bandpass',   {{'low', 'high', 'order'}}, ...
+            'lowpass',    {{'cutoff', 'order'}}, ...
+            'highpass',   {{'cutoff', 'order'}}, ...
+            'gauss',      {{'cutoff', 'order'}}, ...
+            'detrend',    {{'window'}}, ...
+            'ss_regress', {{'window'}}, ...
+            'roi_mean',   {{}});
+    end
+
+    properties
+        names       string  = strings(1,0); % stage names in order
+        stages      cell    = {};           % y = stage(x, ss) per stage
+        objects     cell    = {};           % DSP object per stage ([] = none)
+        width       double  = 0;            % output columns
+    end
+
+    methods
+        function self = stagechain(spec, config, type)
+            %STAGECHAIN Compile spec (see parse) for the columns of a type
+            if nargin < 2, return; end
+            if nargin < 3, type = "HbO"; end
+            srate = config.srate;
+            nss = 0;
+            if isfield(config.SScounts, 'HbO')
+                nss = config.SScounts.HbO;
+            end
+            self.width = config.counts.(type);
+            for s = spec(:)'
+                a = s.args;
+                switch s.stage
+                    case "mbll"
+                        if ~isfield(config.device, 'mbll') || ~config.device.mbll.enabled
+                            error('stagechain:NoMbll', ...
+                                'Stage "mbll" needs "mbll": {"enabled": true} in the device JSON.');
+                        end
+                        obj = [];
+                        fn  = @(x, ~) x;
+                    case {"bandpass", "lowpass", "highpass"}
+                        if s.stage == "bandpass"
+                            fc = stagechain.arg(a, 1:2, [0.01 0.5]);
+                            order = stagechain.arg(a, 3, 3);
+                        else
+                            fc = stagechain.arg(a, 1, 0.5);
+                            order = stagechain.arg(a, 2, 3);
+                        end
+                        kind = replace(s.stage, ["lowpass" "highpass"], ["low" "high"]);
+                        obj = sosfilter(butterworth(order, fc, srate, kind), self.width, 1);
+                        fn  = @(x, ~) obj.push(x);
+                    case "gauss"
+                        h   = gausskernel(stagechain.arg(a, 1, 0.022), stagechain.arg(a, 2, 15));
+                        obj = firfilter(h, self.width, 1);
+                        fn  = @(x, ~) obj.push(x);
+                    case "detrend"
+                        len = stagechain.rows(a, srate, config.windowsize);
+                        obj = detrender(len, self.width);
+                        fn  = @(x, ~) obj.push(x);
+                    case "ss_regress"
+                        if nss == 0
+                            warning("stagechain: no short channels selected, ss_regress passes data through");
+                            obj = [];
+                            fn  = @(x, ~) x;
+                        else
+                            len = stagechain.rows(a, srate, config.windowsize);
+                            obj = ssregression(len, self.width, nss, "mean");
+                            fn  = @(x, ss) stagechain.regress(obj, x, ss);
+                        end
+                    case "roi_mean"
+                        W = roiweights(config, type);
+                        if isempty(W) || size(W,1) ~= self.width
+                            W = ones(self.width, 1) / self.width;
+                        end
+                        obj = [];
+                        fn  = @(x, ~) x * W;
+                        self.width = size(W, 2);
+                    otherwise
+                        error('stagechain:BadStage', 'Unknown pipeline stage "%s".', s.stage);
+                end
+                self.names(end+1)   = s.stage;
+                self.objects{end+1} = obj;
+                self.stages{end+1}  = fn;
+            end
+        end
+
+        function x = push(self, x, ss)
+            %PUSH Run a block (n x columns) and its short channels through
+            if nargin < 3, ss = zeros(size(x,1), 0); end
+            for k = 1:numel(self.stages)
+                x = self.stages{k}(x, ss);
+            end
+        end
+
+        function reset(self)
+            for k = 1:numel(self.objects)
+                if ~isempty(self.objects{k})
+                    self.objects{k}.reset();
+                end
+            end
+        end
+    end
+
+    methods (Static)
+        function spec = parse(json)
+            %PARSE Normalize the JSON stage list to struct('stage','args')
+            spec = struct('stage', {}, 'args', {});
+            if isempty(json), return; end
+            if isstruct(json), json = num2cell(json); end
+            for k = 1:numel(json)
+                s = json{k};
+                if iscell(s)
+                    % ["bandpass", 0.01, 0.5]
+                    name = lower(string(s{1}));
+                    args = cell2mat(s(2:end));
+                elseif isstruct(s)
+                    % {"stage": "bandpass", "low": 0.01, ...}
+                    name = lower(string(s.stage));
+                    args = [];
+                    if isfield(stagechain.PARAMS, name)
+                        for p = stagechain.PARAMS.(name)
+                            if ~isfield(s, p{1}), break; end
+                            args(end+1) = s.(p{1}); %#ok<AGROW>
+                        end
+                    end
+                else
+                    % "roi_mean"
+                    name = lower(string(s));
+                    args = [];
+                end
+                if ~isfield(stagechain.PARAMS, name)
+                    error('stagechain:BadStage', 'Unknown pipeline stage "%s".', name);
+                end
+                spec(end+1) = struct('stage', name, 'args', double(args(:)')); %#ok<AGROW>
+            end
+        end
+    end
+
+    methods (Static, Access = private)
+        function v = arg(a, i, default)
+            if numel(a) >= max(i)
+                v = a(i);
+            else
+                v = default;
+            end
+        end
+
+        function n = rows(a, srate, default)
+            %ROWS Window length in rows from seconds (default in rows)
+            if isempty(a)
+                n = default;
+            else
+                n = round(a(1) * srate);
+            end
+            n = max(n, 2);
+        end
+
+        function y = regress(obj, x, ss)
+            % subtract the mean short channel times the window weights
+            y = zeros(size(x));
+            for i = 1:size(x,1)
+                obj.push(x(i,:), ss(i,:));
+                y(i,:) = x(i,:) - mean(ss(i,:)) * obj.beta();
+            end
+        end
+    end
+end
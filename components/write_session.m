@@ -0,0 +1,21 @@
+function write_session(export, matPath)
+%WRITE_SESSION Save a session snapshot using its storage profile.
+%
+% write_session(export, matPath)
+%
+% Inputs:
+%   export  : struct from session.snapshot()
+%   matPath : target .mat file
+%
+% Notes:
+% - export.storage == "compact" stores the encode_session() form, which
+%   MAT v7 (zlib) compresses much better than the full double format.
+% - Use decode_session(load(matPath)) to read either profile.
+
+    if isfield(export, 'storage') && export.storage == "compact"
+        export = encode_session(export);
+        save(matPath, '-struct', 'export', '-v7');
+    else
+        save(matPath, '-struct', 'export');
+    end
+end
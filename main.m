@@ -24,6 +24,8 @@ global myprotocols;
 global myselectchannels;
 global mysettings;
 global myfeedback;
+global myfinalizer;
+global mymonitor;
 
 % init globals
 mylsl            = lsl();
@@ -33,9 +35,11 @@ myprotocols      = protocols();
 myselectchannels = selectchannels();
 mysettings       = app();
 myfeedback       = feedback();
+myfinalizer      = finalizer();
+mymonitor        = appmonitor(mysettings);
 
 % add listeners to lsl
-lhsample = addlistener(mylsl, "NewSample", @onNewSample);
+lhchunk  = addlistener(mylsl, "NewChunk", @onNewChunk);
 
 % add listeners to session
 lhstart  = addlistener(mysession, "Started", @onSessionStarted);
@@ -53,13 +57,16 @@ while isvalid(mysettings) && isvalid(myfeedback.hFig)
     mysettings.update();
     mysession.update();
     myfeedback.centerBar();
+    myfinalizer.update();
+    mymonitor.update();
     
     % update ui and run callbacks
     drawnow limitrate;
     
 end
 
-% shutdown
+% shutdown (finish writing stopped sessions first)
+myfinalizer.wait();
 if isvalid(mysettings)
     delete(mysettings);
 end
@@ -72,10 +79,21 @@ close all force;
 
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 
-function onNewSample(src, ~)
+function onNewChunk(src, ~)
     global mysession;
-    mysession.pushSample(src.sample, src.SSsample, src.timestamp);
-    mysession.update();
+    global myprotocols;
+    if isempty(myprotocols.active)
+        % v1 protocols are evaluated sample by sample
+        for k = 1:size(src.chunk,1)
+            mysession.pushSample(src.chunk(k,:), src.SSchunk(k,:), src.timestamps(k), ...
+                src.weightchunk(k,:));
+            mysession.update();
+        end
+    else
+        % v2 protocols evaluate all pending samples in one call
+        mysession.pushBlock(src.chunk, src.SSchunk, src.timestamps, src.weightchunk);
+        mysession.update();
+    end
 end
 
 function onSessionStarted(src, ~)
@@ -85,21 +103,21 @@ function onSessionStarted(src, ~)
     mylsl.marker = 0;
     mylsl.trigger(100);
     myfeedback.setMode("hidden");
-    myprotocols.selected.fh.init();
+    myprotocols.start(src.protocolconfig());
 end
 
 function onSessionStopped(src, ~)
     global mylsl;
     global myfeedback;
     global myprotocols;
+    global myfinalizer;
     mylsl.marker = 0;
     mylsl.trigger(101);
     myfeedback.setBackground(src.bgcolor);
     myfeedback.setMode("hidden");
-    myprotocols.selected.fh.finish(src);
 
-    % A centralized save with the correct name & directory
-    save_session_plot(src);
+    % save, plot and export off the UI thread
+    myfinalizer.submit(src, myprotocols.finisher());
 end
 
 function onSessionEpoch(src, ~)
@@ -128,34 +146,66 @@ function onSessionWindow(src, ~)
     global myfeedback;
     global myprotocols;
 
-    prevNormFb  = 0.5;
-    if src.idx > 1
-        prevNormFb  = src.normFeedback(src.idx-1);
-    end
-    
-    prevmarker = 0;
-    if src.idx > 1
-        prevmarker = src.markers(src.idx-1);
+    % rows added since the last window event
+    fresh = double(src.idx - src.fbidx);
+
+    % scheduler: hold previous feedback if this window is skipped
+    sched = src.schedule;
+    if ~sched.due(fresh)
+        src.pushFeedback(repmat(sched.rawHold, fresh, 1), ...
+                         repmat(sched.normHold, fresh, 1), 0.0);
+        return;
     end
 
+    p = myprotocols.active;
     tick = tic();
-    [rawFb, normFb] = myprotocols.selected.fh.process (...
-        src.marker,    ...
-        src.srate, ...
-        src.idx,   ...
-        src.data, ...
-        src.SSdata, ...
-        src.windownum, ...
-        src.window, ...
-        src.SSwindow, ...
-        src.windowidx >= src.windowsize, ...
-        prevNormFb , ...
-        prevmarker);
+    if ~isempty(p)
+        % v2: stateful instance, fed only the samples since its last call
+        [block, times, markers] = src.rows(p.samplenum+1, src.idx);
+        if numel(markers) > 1
+            [rawFb, normFb] = p.processBlock(block, times, markers);
+        else
+            p.consume(block, times, markers);
+            [rawFb, normFb] = p.feedback();
+        end
+    else
+        prevNormFb  = 0.5;
+        if src.idx > 1
+            prevNormFb  = src.normFeedback(src.idx-1);
+        end
+
+        prevmarker = 0;
+        if src.idx > 1
+            prevmarker = src.markers(src.idx-1);
+        end
+
+        [rawFb, normFb] = myprotocols.selected.fh.process (...
+            src.markers(src.idx), ...
+            src.srate, ...
+            src.idx,   ...
+            src.protocoldata(), ...
+            src.SSdata, ...
+            src.windownum, ...
+            src.window, ...
+            src.SSwindow, ...
+            src.windowidx >= src.windowsize, ...
+            prevNormFb , ...
+            prevmarker);
+    end
     span = toc(tick);
 
+    % budget of the rows this call processed (v2 catches up after skips)
+    rows = fresh;
+    if ~isempty(p)
+        rows = max(numel(markers), 1);
+    end
+    src.profile.record(span, src.markers(src.idx), rows);
+
     % clamp the normalized feedback, send it to the UI/session
+    % (rows held while skipping keep the feedback that was shown)
     normFb = min(max(normFb, 0.0), 1.0);
-    myfeedback.setFeedback(normFb);
-    src.pushFeedback(rawFb, normFb, span);
-    
+    sched.record(span, rawFb(end), normFb(end));
+    myfeedback.setFeedback(normFb(end));
+    src.pushFeedback(rawFb(end-fresh+1:end), normFb(end-fresh+1:end), span);
 end
+
@@ -0,0 +1,94 @@
+classdef Connectivity < nfprotocol
+    %CONNECTIVITY Feedback on the HbO correlation between ROIs
+    %   ROIs are groups of long channels (devch numbers) in the device
+    %   JSON, e.g. channel_map.rois = {"left_dlpfc": [1,2,3],
+    %   "right_dlpfc": [4,5,6]}. The mean HbO of each ROI is correlated
+    %   with every other ROI over a sliding window of WINDOW seconds,
+    %   updated incrementally per sample (slidingcorr). During task
+    %   (marker 3) the feedback is the mean correlation over all pairs,
+    %   mapped to [0,1] by the adaptive normalization.
+
+    properties (Constant)
+        WINDOW      = 20.0;                 % correlation window (s)
+    end
+
+    properties
+        Corr        = [];                   % slidingcorr over ROI pairs
+        names       string  = strings(1,0); % ROI names
+        pairs       double  = zeros(0,2);   % ROI index pairs
+        Wa          double  = zeros(0,0);   % HbO -> first ROI of each pair
+        Wb          double  = zeros(0,0);   % HbO -> second ROI of each pair
+        r           double  = zeros(1,0);   % last correlation per pair
+    end
+
+    methods
+        % REQUIREMENTS FOR PROTOCOL
+        function r = requires(~)
+            r.devicetype = "NIRS";
+            % required window min and max durations
+            r.window.mins = 1.0;
+            r.window.maxs = 10.0;
+            % requires at least two HbO channels
+            r.channels(1).type = "HbO";
+            r.channels(1).unit = "μmol/L";
+            r.channels(1).min = 2;
+            r.channels(1).max = 64;
+        end
+
+        % EXECUTED ONCE ON START
+        function init(self, config)
+            init@nfprotocol(self, config);
+            W = self.roimatrix(config);
+            self.pairs = nchoosek(1:size(W,2), 2);
+            self.Wa = W(:, self.pairs(:,1));
+            self.Wb = W(:, self.pairs(:,2));
+            len = max(round(self.WINDOW * config.srate), 2);
+            self.Corr = slidingcorr(len, size(self.pairs,1));
+            self.r = nan(1, size(self.pairs,1));
+        end
+
+        function consume(self, block, timestamps, markers)
+            self.processBlock(block, timestamps, markers);
+        end
+
+        function [rawFeedback, normFeedback] = processBlock(self, block, ~, markers)
+            n = numel(markers);
+            a = block.HbO * self.Wa;
+            b = block.HbO * self.Wb;
+            rawFeedback  = zeros(n, 1);
+            normFeedback = 0.5 * ones(n, 1);
+            for i = 1:n
+                self.Corr.push(a(i,:), b(i,:));
+                if markers(i) == 3
+                    self.r = self.Corr.corr();
+                    if all(isfinite(self.r))
+                        rawFeedback(i)  = mean(self.r);
+                        normFeedback(i) = self.Norm.push(rawFeedback(i), 3);
+                    end
+                end
+            end
+            self.samplenum    = self.samplenum + n;
+            self.marker       = markers(end);
+            self.rawFeedback  = rawFeedback(end);
+            self.normFeedback = normFeedback(end);
+        end
+    end
+
+    methods (Access = protected)
+        function W = roimatrix(self, config)
+            %ROIMATRIX Averaging matrix from HbO columns to ROIs (ch x roi)
+            %   Without two channel_map.rois the selected channels are
+            %   split into two halves (first vs. second half).
+            [W, self.names] = roiweights(config, "HbO");
+            if size(W,2) < 2
+                warning("Connectivity: less than two ROIs, splitting channels in halves");
+                nch  = size(W,1);
+                half = floor(nch / 2);
+                W = zeros(nch, 2);
+                W(1:half, 1) = 1 / half;
+                W(half+1:end, 2) = 1 / (nch - half);
+                self.names = ["first" "second"];
+            end
+        end
+    end
+end
@@ -0,0 +1,88 @@
+classdef EEGBandPower < nfprotocol
+    %EEGBANDPOWER Relative alpha power feedback for EEG
+    %   Raw EEG blocks go into a streaming Welch engine (bandpower) that
+    %   emits theta/alpha/beta power per channel at RATE Hz. The feedback
+    %   is the alpha share of the summed band power, averaged over
+    %   channels, and is held between two feature outputs. Suited for
+    %   high sample rates since per-sample work is a ring write only.
+
+    properties (Constant)
+        BANDS       = [4 8; 8 13; 13 30];   % theta, alpha, beta (Hz)
+        TARGET      = 2;                    % feedback band (row in BANDS)
+        RATE        = 20;                   % feature output rate (Hz)
+        WINDOW      = 1.0;                  % analysis window (s)
+    end
+
+    properties
+        Engine      = [];                   % bandpower over EEG channels
+        features    double  = zeros(0,0);   % last band power (channels x bands)
+    end
+
+    methods
+        % REQUIREMENTS FOR PROTOCOL
+        function r = requires(~)
+            r.devicetype = "EEG";
+            % required window min and max durations
+            r.window.mins = 1.0;
+            r.window.maxs = 10.0;
+            % requires at least one EEG channel
+            r.channels(1).type = "EEG";
+            r.channels(1).unit = "μV";
+            r.channels(1).min = 1;
+            r.channels(1).max = 128;
+        end
+
+        % EXECUTED ONCE ON START
+        function init(self, config)
+            init@nfprotocol(self, config);
+            self.Engine = bandpower(config.srate, config.counts.EEG, ...
+                self.BANDS, self.RATE, self.WINDOW);
+            self.features = zeros(config.counts.EEG, size(self.BANDS,1));
+        end
+
+        function consume(self, block, timestamps, markers)
+            self.processBlock(block, timestamps, markers);
+        end
+
+        function [rawFeedback, normFeedback] = processBlock(self, block, ~, markers)
+            n = numel(markers);
+            [P, at] = self.Engine.push(block.EEG);
+
+            % hold the last feedback until the next feature row
+            rawFeedback  = repmat(self.rawFeedback, n, 1);
+            normFeedback = repmat(self.normFeedback, n, 1);
+            for k = 1:size(P,1)
+                self.features = reshape(P(k,:,:), size(P,2), size(P,3));
+                share = self.features(:,self.TARGET) ./ ...
+                    max(sum(self.features, 2), eps);
+                self.rawFeedback  = mean(share);
+                self.normFeedback = self.rawFeedback;
+                rawFeedback(at(k):end)  = self.rawFeedback;
+                normFeedback(at(k):end) = self.normFeedback;
+            end
+            self.samplenum = self.samplenum + n;
+            self.marker    = markers(end);
+        end
+
+        % EXECUTED AT THE END OF THE SESSION
+        function finish(~, session)
+            ploth = figure('Name', 'Session Plot');
+            ploth.NumberTitle = 'off';
+
+            % Plotting EEG mean channel
+            subplot(3,1,1);
+            plot(mean(session.data.EEG,2),'k');
+            title('EEG [μV]');
+
+            % Plotting Feedback values
+            subplot(3,1,2);
+            plot(session.normFeedback(:,1));
+            title('Feedback (alpha share)');
+
+            % Plotting Marker Values
+            subplot(3,1,3);
+            plot(session.markers(:,1));
+            title('Marker');
+        end
+    end
+end
@@ -0,0 +1,101 @@
+classdef GLM < nfprotocol
+    %GLM Online GLM feedback on the task response of HbO
+    %   Regressors shared by all HbO channels:
+    %   - constant
+    %   - task boxcar (marker 3) convolved with the canonical HRF
+    %   - mean short channel HbO / HbR (if selected)
+    %   - polynomial drift over the session
+    %   They are fitted by recursive least squares (rlsglm) with slow
+    %   forgetting. The feedback is the t-like statistic of the task
+    %   coefficient averaged over channels, mapped to [0,1] by the
+    %   normal CDF, so no expected amplitudes have to be configured.
+
+    properties (Constant)
+        ORDER       = 2;                    % polynomial drift order
+        LAMBDA      = 0.9995;               % forgetting factor (~200 s at 10 Hz)
+    end
+
+    properties
+        Model       = [];                   % rlsglm over HbO channels
+        HRF         = [];                   % firfilter convolving the boxcar
+        SStypes     string  = strings(1,0); % short channel regressor types
+        duration    double  = 1;            % session length for drift (s)
+        taskValue   double  = 0.0;          % mean task coefficient
+    end
+
+    methods
+        % REQUIREMENTS FOR PROTOCOL
+        function r = requires(~)
+            r.devicetype = "NIRS";
+            % required window min and max durations
+            r.window.mins = 1.0;
+            r.window.maxs = 10.0;
+            % requires at least one HbO channel
+            r.channels(1).type = "HbO";
+            r.channels(1).unit = "μmol/L";
+            r.channels(1).min = 1;
+            r.channels(1).max = 64;
+            % short channels are optional regressors
+            r.SSchannels(1).type = "HbO";
+            r.SSchannels(1).unit = "μmol/L";
+            r.SSchannels(1).min = 0;
+            r.SSchannels(1).max = 64;
+            r.SSchannels(2).type = "HbR";
+            r.SSchannels(2).unit = "μmol/L";
+            r.SSchannels(2).min = 0;
+            r.SSchannels(2).max = 64;
+        end
+
+        % EXECUTED ONCE ON START
+        function init(self, config)
+            init@nfprotocol(self, config);
+            self.SStypes = intersect(["HbO" "HbR"], string(fieldnames(config.SScounts))');
+            self.duration = max(double(config.datasize) / config.srate, 1);
+            p = 2 + numel(self.SStypes) + self.ORDER;
+            self.Model = rlsglm(p, config.counts.HbO, self.LAMBDA);
+            self.HRF = firfilter(hrfkernel(config.srate), 1, 1);
+            self.taskValue = 0.0;
+        end
+
+        function consume(self, block, timestamps, markers)
+            self.processBlock(block, timestamps, markers);
+        end
+
+        function [rawFeedback, normFeedback] = processBlock(self, block, ~, markers)
+            n = numel(markers);
+            X = self.design(block, markers);
+            rawFeedback  = zeros(n, 1);
+            normFeedback = 0.5 * ones(n, 1);
+            for i = 1:n
+                self.Model.push(X(i,:), block.HbO(i,:));
+                if markers(i) == 3
+                    z = mean(self.Model.tstat(2));
+                    rawFeedback(i)  = mean(self.Model.B(2,:));
+                    normFeedback(i) = 0.5 * erfc(-z / sqrt(2));
+                end
+            end
+            self.samplenum    = self.samplenum + n;
+            self.marker       = markers(end);
+            self.taskValue    = mean(self.Model.B(2,:));
+            self.rawFeedback  = rawFeedback(end);
+            self.normFeedback = normFeedback(end);
+        end
+    end
+
+    methods (Access = protected)
+        function X = design(self, block, markers)
+            %DESIGN Regressor rows for a block (n x p)
+            n = numel(markers);
+            task = self.HRF.push(double(markers(:) == 3));
+            ss = zeros(n, numel(self.SStypes));
+            for k = 1:numel(self.SStypes)
+                ss(:,k) = mean(block.SS.(self.SStypes(k)), 2);
+            end
+            % drift in [-1,1] over the session length
+            t = (self.samplenum + (1:n)') / self.config.srate;
+            t = 2 * t / self.duration - 1;
+            drift = t .^ (1:self.ORDER);
+            X = [ones(n,1), task, ss, drift];
+        end
+    end
+end
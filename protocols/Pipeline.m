@@ -0,0 +1,57 @@
+classdef Pipeline < restprotocol
+    %PIPELINE Rest vs. task HbO feedback on the device's JSON pipeline
+    %   The HbO channels go through the preprocessing chain declared as
+    %   "pipeline" in the device JSON (see components/stagechain.m), e.g.
+    %   [["bandpass", 0.01, 0.5], ["ss_regress"], ["roi_mean"]]. Only
+    %   the window average and the rest/task mapping are done here.
+    %   Without a pipeline the raw HbO channels are used.
+
+    properties
+        Chain       stagechain;               % compiled preprocessing chain
+        Window      slidingwindow;          % chain output window
+    end
+
+    methods
+        % REQUIREMENTS FOR PROTOCOL
+        function r = requires(self)
+            r = requires@restprotocol(self);
+            % short channels for an ss_regress stage (optional)
+            r.SSchannels(1).type = "HbO";
+            r.SSchannels(1).unit = "μmol/L";
+            r.SSchannels(1).min = 0;
+            r.SSchannels(1).max = 64;
+        end
+
+        % EXECUTED ONCE ON START
+        function init(self, config)
+            init@restprotocol(self, config);
+            spec = stagechain.parse([]);
+            if isfield(config.device, 'pipeline')
+                spec = config.device.pipeline;
+            end
+            self.Chain  = stagechain(spec, config, "HbO");
+            self.Window = slidingwindow(config.windowsize, self.Chain.width);
+            % rest buffer holds the chain output
+            self.rest = restbaseline(config.srate, self.Chain.width, ...
+                size(self.rest.SSbuf, 2));
+        end
+    end
+
+    methods (Access = protected)
+        function y = transform(self, x, ss)
+            y = self.Chain.push(x, ss);
+            self.Window.push(y);
+        end
+
+        function [y, wm] = transformBlock(self, x, ss, need)
+            % whole block through the chain, window means for task rows
+            y  = self.Chain.push(x, ss);
+            wm = self.Window.push(y, need);
+        end
+
+        function m = windowmean(self)
+            % mean of the chain output over time and columns
+            m = self.Window.grandmean();
+        end
+    end
+end
@@ -0,0 +1,75 @@
+classdef appmonitor < handle
+    %APPMONITOR Session status shown in the settings app at runtime
+    %   The settings app is designed in App Designer (app.mlapp); labels
+    %   for state kept outside the app are updated from here through its
+    %   public components, so the designer file stays untouched.
+    %   - STATUS shows the finalizer progress while no session runs
+    %   - OVER (third row of PROTOCOL TIME) shows the share of recent
+    %     protocol calls over budget, per-marker timings in its tooltip
+
+    properties
+        app         = [];                   % settings app (app.mlapp)
+        status      string  = "";           % last finalizer status shown
+        OverLabel   = [];                   % share of calls over budget
+        OverDesc    = [];                   % OVER: caption
+        running     logical = false;        % session running at last update
+        tick        uint64;                 % last OVER refresh
+    end
+
+    methods
+        function self = appmonitor(app)
+            self.app  = app;
+            self.tick = tic();
+
+            % OVER row in the free third row of PROTOCOL TIME
+            self.OverLabel = uilabel(app.GridLayout5);
+            self.OverLabel.HorizontalAlignment = 'center';
+            self.OverLabel.Layout.Row = 3;
+            self.OverLabel.Layout.Column = 2;
+            self.OverLabel.Text = '-';
+            self.OverDesc = uilabel(app.GridLayout5);
+            self.OverDesc.HorizontalAlignment = 'center';
+            self.OverDesc.Layout.Row = 3;
+            self.OverDesc.Layout.Column = 1;
+            self.OverDesc.Text = 'OVER:';
+        end
+
+        function update(self)
+            global mysession;
+            global myfinalizer;
+            if isempty(self.app) || ~isvalid(self.app)
+                return;
+            end
+            if mysession.running
+                if toc(self.tick) >= 0.5
+                    self.updateOver();
+                    self.tick = tic();
+                end
+            else
+                % last values of a session that just stopped
+                if self.running
+                    self.updateOver();
+                end
+                if myfinalizer.status ~= self.status
+                    self.status = myfinalizer.status;
+                    if strlength(self.status) > 0
+                        self.app.SESSIONSTATUSLabel.Text = self.status;
+                    end
+                end
+            end
+            self.running = mysession.running;
+        end
+
+        function updateOver(self)
+            global mysession;
+            over = mysession.profile.recentover();
+            self.OverLabel.Text = sprintf('%.1f', 100*over) + " %";
+            self.OverLabel.Tooltip = cellstr(mysession.profile.summary());
+            if over > 0.05
+                self.OverLabel.BackgroundColor = 'red';
+            else
+                self.OverLabel.BackgroundColor = 'green';
+            end
+        end
+    end
+end
@@ -1,6 +1,8 @@
-function save_session_plot(session)
+function save_session_plot(session, pngPath)
 % Save the protocol's "Session Plot" with the standardized name.
 % Robust to string paths, collisions, and figure lookup.
+% pngPath is optional; it is used as-is when the caller already reserved
+% a file name (e.g. the finalizer running on a background worker).
 
 % Find the figure created by the protocol
 fig = findobj(0, 'Type','figure', 'Name','Session Plot');
@@ -16,34 +18,36 @@ else
     fig = fig(1);  % most recent
 end
 
-% Study folder & safe name
-studyName = session.study;
-if studyName == "", studyName = "unnamed"; end
-safeStudy = regexprep(string(studyName), '[^A-Za-z0-9._-]', '_');
+if nargin < 2 || strlength(pngPath) == 0
+    % Study folder & safe name
+    studyName = session.study;
+    if studyName == "", studyName = "unnamed"; end
+    safeStudy = regexprep(string(studyName), '[^A-Za-z0-9._-]', '_');
 
-baseDir = fullfile("sessions", safeStudy);
-if ~isfolder(baseDir)
-    mkdir(baseDir);
-end
+    baseDir = fullfile("sessions", safeStudy);
+    if ~isfolder(baseDir)
+        mkdir(baseDir);
+    end
 
-% Timestamp (second precision).
-ts = string(datetime(session.starttime, 'ConvertFrom','datenum', ...
-                     'Format','yyyy-MM-dd_HH-mm-ss'));
+    % Timestamp (second precision).
+    ts = string(datetime(session.starttime, 'ConvertFrom','datenum', ...
+                         'Format','yyyy-MM-dd_HH-mm-ss'));
 
-% Base filename (blind: no protocol/device)
-baseName = sprintf("%s_S%03d_R%02d_%s", safeStudy, session.subject, session.run, ts);
-pngPath  = fullfile(baseDir, baseName + ".png");
+    % Base filename (blind: no protocol/device)
+    baseName = sprintf("%s_S%03d_R%02d_%s", safeStudy, session.subject, session.run, ts);
+    pngPath  = fullfile(baseDir, baseName + ".png");
 
-% Collision-safe suffix (_v02, _v03, …)
-if isfile(pngPath)
-    k = 2;
-    while true
-        candidate = fullfile(baseDir, baseName + sprintf("_v%02d.png", k));
-        if ~isfile(candidate)
-            pngPath = candidate;
-            break;
+    % Collision-safe suffix (_v02, _v03, …)
+    if isfile(pngPath)
+        k = 2;
+        while true
+            candidate = fullfile(baseDir, baseName + sprintf("_v%02d.png", k));
+            if ~isfile(candidate)
+                pngPath = candidate;
+                break;
+            end
+            k = k + 1;
         end
-        k = k + 1;
     end
 end
 